@@ -1,56 +1,86 @@
-#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
 #include <iostream>
+#include <string>
 
-const int SIZE = 10;
+#include "chessboard.hpp"
+#include "display.hpp"
+#include "mapped_image.hpp"
+#include "run_report.hpp"
+#include "trace.hpp"
 
-int main() {
-    // Путь к файлу изображения; настройте его в соответствии с вашим окружением
-    std::string imagePath = "source/2024-02-05 13.47.36.jpg";
+int main(int argc, char** argv) {
+    std::string imagePath; // путь к файлу изображения, обязательный
+    std::string outputFilename = "chessboard.png"; // -o <файл>: результат
+    int size = 10; // -size <пиксели>: сторона клетки шахматной маски
+    bool show = false; // -show: окно с результатом (только в сборке с MISIS_WITH_DISPLAY)
+    std::string tracePath; // -trace <файл>: этапы обработки в формате Chrome trace JSON
+    RunReport report("chessboard"); // -report <файл или ->: итог запуска в JSON
 
-    // Загрузка изображения
-    cv::Mat image = cv::imread(imagePath, cv::IMREAD_COLOR);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            outputFilename = argv[++i];
+        } else if (arg == "-size" && i + 1 < argc) {
+            size = std::stoi(argv[++i]);
+        } else if (arg == "-show") {
+            show = true;
+        } else if (arg == "-trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "-report" && i + 1 < argc) {
+            report.setPath(argv[++i]);
+        } else {
+            imagePath = arg;
+        }
+    }
+    if (imagePath.empty() || size <= 0) {
+        std::cout << "Usage: " << argv[0] << " <image> [-o <output>] [-size <cell>] [-show]"
+                  << " [-trace <file>] [-report <file>]" << std::endl;
+        return report.finish(kExitUsage);
+    }
+    report.set("input", imagePath);
+    report.set("output", outputFilename);
+    report.set("size", size);
 
-    if(image.empty()) // Проверка на неудачную загрузку
+    if (!tracePath.empty()) {
+        traceStart(tracePath);
+    }
+
+    // Загрузка изображения; PGM/PPM/raw отображаются в память без копирования
+    MappedImage mapped;
+    cv::Mat image;
     {
-        std::cout << "Could not open or find the image" << std::endl;
-        std::cin.get(); // Ожидание нажатия клавиши
-        return -1;
-    }
-
-    // Переворачиваем изображение
-    cv::Mat flippedImage;
-    cv::flip(image, flippedImage, 0);
-
-    // Инвертируем цвета изображения
-    cv::Mat invertedImage;
-    cv::bitwise_not(flippedImage, invertedImage);
-
-    // Создание шахматной маски того же размера, что и изображение
-    cv::Mat mask = cv::Mat::zeros(invertedImage.rows, invertedImage.cols, CV_8UC1);
-    for(int y = 0; y < mask.rows; ++y) {
-        for(int x = 0; x < mask.cols; ++x) {
-            if((x / SIZE) % 2 == (y / SIZE) % 2) { // Изменение размера клетки можно настроить через делитель
-                mask.at<uchar>(y, x) = 255;
-            }
-        }
+        TraceScope scope("load", imagePath);
+        image = readImage(imagePath, mapped, cv::IMREAD_COLOR);
     }
 
-    // Преобразуем маску из одного канала в три канала для соответствия изображению
-    cv::Mat maskColor;
-    cv::cvtColor(mask, maskColor, cv::COLOR_GRAY2BGR);
+    if(image.empty()) // Проверка на неудачную загрузку
+    {
+        std::cout << "Could not open or find the image " << imagePath << std::endl;
+        traceFinish();
+        return report.finish(kExitInput);
+    }
 
-    // Применяем маску через побитовое И к инвертированному изображению
+    // Переворот, инверсия и шахматная маска за один проход
     cv::Mat result;
-    cv::bitwise_and(invertedImage, maskColor, result);
-
-    // Создаём окно для отображения
-    cv::namedWindow("Chessboard Masked Image", cv::WINDOW_NORMAL);
+    {
+        TraceScope scope("chessboard");
+        flipInvertChessboard(image, result, size);
+    }
 
-    // Показываем результат в окне
-    cv::imshow("Chessboard Masked Image", result);
+    bool written;
+    {
+        TraceScope scope("encode", outputFilename);
+        written = writeImage(outputFilename, result);
+    }
+    traceFinish();
+    if (!written) {
+        std::cout << "Could not write " << outputFilename << std::endl;
+    }
 
-    // Ожидание нажатия клавиши
-    cv::waitKey(0);
+    // Показываем результат в окне по запросу
+    if (show) {
+        showImages({{"Chessboard Masked Image", result}});
+    }
 
-    return 0;
+    return report.finish(written ? kExitOk : kExitOutput);
 }
@@ -0,0 +1,118 @@
+#include "benchmark.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/utility.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+
+#include "json.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Время одного прогона: по часам и процессорное, нс
+void timeIterations(const BenchmarkSuite::Kernel& kernel, int64_t iterations, double& realNs, double& cpuNs) {
+    std::clock_t cpuStart = std::clock();
+    Clock::time_point start = Clock::now();
+    for (int64_t i = 0; i < iterations; ++i) {
+        kernel();
+    }
+    realNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    cpuNs = static_cast<double>(std::clock() - cpuStart) * 1e9 / CLOCKS_PER_SEC;
+}
+
+bool writeJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream json(path);
+    if (!json) return false;
+
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    json << std::setprecision(10);
+    json << "{\n  \"context\": {\n"
+         << "    \"date\": \"" << date << "\",\n"
+         << "    \"num_cpus\": " << cv::getNumberOfCPUs() << ",\n"
+         << "    \"num_threads\": " << cv::getNumThreads() << ",\n"
+         << "    \"opencv_version\": \"" << CV_VERSION << "\",\n"
+#ifdef NDEBUG
+         << "    \"library_build_type\": \"release\"\n"
+#else
+         << "    \"library_build_type\": \"debug\"\n"
+#endif
+         << "  },\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        double seconds = r.realTimeNs * 1e-9;
+        json << "    {\n"
+             << "      \"name\": \"" << jsonEscape(r.name) << "\",\n"
+             << "      \"run_name\": \"" << jsonEscape(r.name) << "\",\n"
+             << "      \"run_type\": \"iteration\",\n"
+             << "      \"iterations\": " << r.iterations << ",\n"
+             << "      \"real_time\": " << r.realTimeNs << ",\n"
+             << "      \"cpu_time\": " << r.cpuTimeNs << ",\n"
+             << "      \"time_unit\": \"ns\",\n"
+             << "      \"bytes_per_second\": " << r.bytes / seconds << ",\n"
+             << "      \"items_per_second\": " << r.pixels / seconds << "\n"
+             << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+    return static_cast<bool>(json);
+}
+
+}
+
+void BenchmarkSuite::add(const std::string& name, double pixels, double bytes, Setup setup) {
+    entries_.push_back(Entry{name, pixels, bytes, setup});
+}
+
+int BenchmarkSuite::run(const BenchmarkOptions& options) const {
+    std::regex filter(options.filter.empty() ? ".*" : options.filter);
+    std::vector<BenchmarkResult> results;
+
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(14) << "Time, ms" << std::setw(12) << "Iterations"
+              << std::setw(12) << "MPix/s" << std::setw(12) << "GB/s" << std::endl;
+
+    for (const Entry& entry : entries_) {
+        if (!std::regex_search(entry.name, filter)) continue;
+
+        Kernel kernel = entry.setup();
+
+        // Первый прогон — прогрев и оценка числа итераций
+        double realNs = 0, cpuNs = 0;
+        timeIterations(kernel, 1, realNs, cpuNs);
+        int64_t iterations = static_cast<int64_t>(std::ceil(options.minTime * 1e9 / std::max(realNs, 1.0)));
+        iterations = std::max<int64_t>(1, std::min<int64_t>(iterations, 1000000000));
+        timeIterations(kernel, iterations, realNs, cpuNs);
+
+        BenchmarkResult result;
+        result.name = entry.name;
+        result.iterations = iterations;
+        result.realTimeNs = realNs / iterations;
+        result.cpuTimeNs = cpuNs / iterations;
+        result.pixels = entry.pixels;
+        result.bytes = entry.bytes;
+        results.push_back(result);
+
+        double seconds = result.realTimeNs * 1e-9;
+        std::cout << std::left << std::setw(40) << entry.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << result.realTimeNs * 1e-6 << std::setw(12) << iterations
+                  << std::setw(12) << entry.pixels / seconds * 1e-6
+                  << std::setw(12) << entry.bytes / seconds * 1e-9 << std::endl;
+    }
+
+    if (!options.jsonPath.empty() && !writeJson(options.jsonPath, results)) {
+        std::cout << "Could not write " << options.jsonPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Параметры запуска набора замеров
+struct BenchmarkOptions {
+    std::string filter;    // регулярное выражение для имён, пустое — все замеры
+    std::string jsonPath;  // файл для JSON-отчёта, пустой — без отчёта
+    double minTime = 0.2;  // минимальное время замера одного ядра, с
+};
+
+// Результат одного замера
+struct BenchmarkResult {
+    std::string name;
+    int64_t iterations;
+    double realTimeNs;   // среднее время итерации по часам
+    double cpuTimeNs;    // среднее процессорное время итерации по всем потокам
+    double pixels;       // пикселей за итерацию
+    double bytes;        // байт прочитано и записано за итерацию
+};
+
+// Набор замеров в духе Google Benchmark: каждое ядро прогоняется, пока не наберётся
+// minTime, и выводит MPix/s и байт/с. JSON-отчёт повторяет формат Google Benchmark,
+// поэтому отчёты разных коммитов можно сравнивать его compare.py
+class BenchmarkSuite {
+public:
+    typedef std::function<void()> Kernel;
+    // Подготовка входных данных выполняется только перед запуском замера и
+    // возвращает одну итерацию ядра; данные освобождаются после замера
+    typedef std::function<Kernel()> Setup;
+
+    void add(const std::string& name, double pixels, double bytes, Setup setup);
+
+    // Возвращает код завершения процесса
+    int run(const BenchmarkOptions& options) const;
+
+private:
+    struct Entry {
+        std::string name;
+        double pixels;
+        double bytes;
+        Setup setup;
+    };
+
+    std::vector<Entry> entries_;
+};
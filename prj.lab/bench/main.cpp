@@ -0,0 +1,171 @@
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "gradient.hpp"
+#include "chessboard.hpp"
+#include "experiment.hpp"
+#include "noise.hpp"
+#include "autocontrast.hpp"
+
+namespace {
+
+struct Resolution {
+    const char* name;
+    int cols;
+    int rows;
+};
+
+const Resolution kResolutions[] = {
+    {"VGA", 640, 480},
+    {"720p", 1280, 720},
+    {"1080p", 1920, 1080},
+    {"4K", 3840, 2160},
+    {"8K", 7680, 4320},
+};
+
+struct Depth {
+    const char* name;
+    int depth;
+};
+
+// Глубины для ядер, обрабатывающих изображения с высокой разрядностью
+const Depth kDepths[] = {
+    {"d8U", CV_8U},
+    {"d16U", CV_16U},
+    {"d32F", CV_32F},
+};
+
+// Значения равномерно заполняют диапазон глубины: [0, 255], [0, 65535] или [0, 1) для float
+cv::Mat randomImage(const Resolution& res, int type) {
+    cv::Mat image(res.rows, res.cols, type);
+    cv::RNG rng(12345);
+    double upper = CV_MAT_DEPTH(type) == CV_16U ? 65536 : CV_MAT_DEPTH(type) == CV_32F ? 1 : 256;
+    rng.fill(image, cv::RNG::UNIFORM, 0, upper);
+    return image;
+}
+
+std::string benchName(const std::string& kernel, const Resolution& res, const std::string& args) {
+    return kernel + "/" + res.name + (args.empty() ? "" : "/" + args);
+}
+
+// Ядра регистрируются на всех разрешениях; входы и выходы выделяются в setup,
+// поэтому в замер попадает только сама обработка (и аллокации самого ядра)
+void registerAll(BenchmarkSuite& suite) {
+    for (const Resolution& res : kResolutions) {
+        double pixels = static_cast<double>(res.cols) * res.rows;
+
+        for (const Depth& d : kDepths) {
+            int depth = d.depth;
+            double elem = static_cast<double>(CV_ELEM_SIZE1(depth));
+            for (int cn : {1, 3, 4}) {
+                for (double gamma : {0.5, 2.4}) {
+                    suite.add(benchName("BM_Gamma", res, "c" + std::to_string(cn) + "/g" + cv::format("%.1f", gamma) +
+                                                         "/" + d.name),
+                              pixels, 2 * pixels * cn * elem, [res, cn, gamma, depth]() {
+                        std::shared_ptr<cv::Mat> src = std::make_shared<cv::Mat>(randomImage(res, CV_MAKETYPE(depth, cn)));
+                        std::shared_ptr<cv::Mat> dst = std::make_shared<cv::Mat>(src->size(), src->type());
+                        return BenchmarkSuite::Kernel([src, dst, gamma]() { applyGammaCorrection(*src, gamma, *dst); });
+                    });
+                }
+            }
+
+            // Шум задаётся в единицах значений: для 16 бит он в 256 раз больше, для float — в 255 раз меньше
+            double unit = depth == CV_16U ? 256.0 : depth == CV_32F ? 1.0 / 255 : 1.0;
+            for (double stddev : {3.0, 15.0}) {
+                suite.add(benchName("BM_AddNoise", res, "s" + std::to_string(static_cast<int>(stddev)) + "/" + d.name),
+                          pixels, 2 * pixels * elem, [res, stddev, depth, unit]() {
+                    std::shared_ptr<cv::Mat> src = std::make_shared<cv::Mat>(randomImage(res, CV_MAKETYPE(depth, 1)));
+                    std::shared_ptr<cv::Mat> dst = std::make_shared<cv::Mat>(src->size(), src->type());
+                    return BenchmarkSuite::Kernel([src, dst, stddev, unit]() { add_noise(*src, stddev * unit, 1, *dst); });
+                });
+            }
+        }
+
+        suite.add(benchName("BM_Histogram", res, ""), pixels, pixels, [res]() {
+            std::shared_ptr<cv::Mat> src = std::make_shared<cv::Mat>(randomImage(res, CV_8UC1));
+            return BenchmarkSuite::Kernel([src]() { draw_histogram(HistogramStats(*src)); });
+        });
+
+        // Результат той же глубины, что и вход: гистограмма и таблица на 65536 значений для 16 бит,
+        // поэлементное растяжение для float
+        for (const Depth& d : kDepths) {
+            int depth = d.depth;
+            double elem = static_cast<double>(CV_ELEM_SIZE1(depth));
+            for (int cn : {1, 3}) {
+                suite.add(benchName("BM_AutoContrast", res, "c" + std::to_string(cn) + "/" + d.name),
+                          pixels, 2 * pixels * cn * elem, [res, cn, depth]() {
+                    std::shared_ptr<cv::Mat> src = std::make_shared<cv::Mat>(randomImage(res, CV_MAKETYPE(depth, cn)));
+                    std::shared_ptr<cv::Mat> dst = std::make_shared<cv::Mat>();
+                    std::shared_ptr<ContrastWorkspace> workspace = std::make_shared<ContrastWorkspace>();
+                    return BenchmarkSuite::Kernel([src, dst, workspace, depth]() {
+                        autoContrastImage(*src, *dst, 0.01, 0.99, *workspace, depth);
+                    });
+                });
+            }
+        }
+
+        // Время до границ растяжения: точные гистограммы против прореженных с погрешностью eps по рангу
+        for (double eps : {0.0, 0.01, 0.002}) {
+            std::string args = eps > 0 ? "e" + cv::format("%g", eps) : "exact";
+            suite.add(benchName("BM_ContrastBounds", res, args), pixels, 3 * pixels, [res, eps]() {
+                std::shared_ptr<cv::Mat> src = std::make_shared<cv::Mat>(randomImage(res, CV_8UC3));
+                std::shared_ptr<ContrastWorkspace> workspace = std::make_shared<ContrastWorkspace>();
+                return BenchmarkSuite::Kernel([src, workspace, eps]() {
+                    for (auto& hist : workspace->histograms) std::fill(hist.begin(), hist.end(), 0);
+                    accumulateSampledHistograms(*src, sampleStep(src->size(), eps), workspace->histograms);
+                    quantileBounds(workspace->histograms, 0.01, 0.99, workspace->bounds);
+                });
+            });
+        }
+
+        for (int cn : {1, 3}) {
+            for (int size : {1, 10, 64}) {
+                suite.add(benchName("BM_Chessboard", res, "c" + std::to_string(cn) + "/size" + std::to_string(size)),
+                          pixels, 2 * pixels * cn, [res, cn, size]() {
+                    std::shared_ptr<cv::Mat> src = std::make_shared<cv::Mat>(randomImage(res, CV_8UC(cn)));
+                    std::shared_ptr<cv::Mat> dst = std::make_shared<cv::Mat>();
+                    return BenchmarkSuite::Kernel([src, dst, size]() { flipInvertChessboard(*src, *dst, size); });
+                });
+            }
+        }
+    }
+
+    // Градиент строится без входного изображения: размер задаётся s и h
+    for (int s : {3, 10}) {
+        for (int h : {30, 120}) {
+            double pixels = 2.0 * s * 256 * h;
+            suite.add("BM_Gradient/s" + std::to_string(s) + "/h" + std::to_string(h), pixels, pixels, [s, h]() {
+                return BenchmarkSuite::Kernel([s, h]() { generateGradient(s, h, 2.4); });
+            });
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "-json" && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "-min_time" && i + 1 < argc) {
+            options.minTime = std::stod(argv[++i]);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [-filter regex] [-json file] [-min_time seconds]" << std::endl;
+            return 1;
+        }
+    }
+
+    BenchmarkSuite suite;
+    registerAll(suite);
+    return suite.run(options);
+}
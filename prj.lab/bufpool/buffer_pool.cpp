@@ -0,0 +1,154 @@
+#include "buffer_pool.hpp"
+
+#include <climits>
+#include <iostream>
+
+namespace {
+
+const size_t kMinClassBytes = 64;
+
+// Номер класса: 4 * p + q для размера 2^p + q * 2^(p-2), q = 0..3
+int sizeClass(size_t bytes) {
+    if (bytes <= kMinClassBytes) bytes = kMinClassBytes;
+    int p = 0;
+    while ((bytes >> (p + 1)) != 0) ++p;
+    size_t base = size_t(1) << p;
+    size_t quarter = base >> 2;
+    int q = static_cast<int>((bytes - base + quarter - 1) / quarter);
+    return 4 * p + q;
+}
+
+size_t classBytes(int index) {
+    size_t base = size_t(1) << (index / 4);
+    return base + (index % 4) * (base >> 2);
+}
+
+// Буфер возвращается в пул, только если он выделен пулом целиком под класс и не связан с UMat
+bool isPoolable(const cv::UMatData* u) {
+    return u->flags == 0 && !u->handle && u->mapcount == 0 && !u->originalUMatData &&
+           u->size >= kMinClassBytes && classBytes(sizeClass(u->size)) == u->size;
+}
+
+}
+
+BufferPool::BufferPool(cv::MatAllocator* base, size_t maxRetainedBytes)
+    : base_(base), budget_(maxRetainedBytes) {}
+
+BufferPool::~BufferPool() {
+    trim();
+}
+
+cv::UMatData* BufferPool::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                                   cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const {
+    // Память вызывающего кода только оборачивается, пулить нечего
+    if (data) {
+        return base_->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    // Шаги непрерывного массива, как у стандартного распределителя
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; --i) {
+        if (step) step[i] = total;
+        total *= sizes[i];
+    }
+
+    int index = sizeClass(total);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv::UMatData* u = free_[index];
+        if (u) {
+            free_[index] = static_cast<cv::UMatData*>(u->userdata);
+            u->userdata = nullptr;
+            u->data = u->origdata;
+            retained_ -= u->size;
+            ++hits_;
+            return u;
+        }
+        ++misses_;
+    }
+
+    // Буфер выделяется на весь класс, чтобы потом подойти любому запросу этого класса.
+    // Больше INT_MAX байт одним отрезком не выделить — такой запрос идёт мимо пула
+    size_t bytes = classBytes(index);
+    if (bytes > static_cast<size_t>(INT_MAX)) {
+        return base_->allocate(dims, sizes, type, nullptr, step, flags, usageFlags);
+    }
+    int length = static_cast<int>(bytes);
+    cv::UMatData* u = base_->allocate(1, &length, CV_8U, nullptr, nullptr, flags, usageFlags);
+    if (u) {
+        u->currAllocator = u->prevAllocator = this;
+    }
+    return u;
+}
+
+bool BufferPool::allocate(cv::UMatData* u, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const {
+    return base_->allocate(u, accessFlags, usageFlags);
+}
+
+void BufferPool::deallocate(cv::UMatData* u) const {
+    if (!u) return;
+    if (isPoolable(u)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (retained_ + u->size <= budget_) {
+            int index = sizeClass(u->size);
+            u->userdata = free_[index];
+            free_[index] = u;
+            retained_ += u->size;
+            return;
+        }
+    }
+    u->currAllocator = u->prevAllocator = base_;
+    base_->deallocate(u);
+}
+
+void BufferPool::trim() const {
+    cv::UMatData* released = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int index = 0; index < kClasses; ++index) {
+            while (cv::UMatData* u = free_[index]) {
+                free_[index] = static_cast<cv::UMatData*>(u->userdata);
+                u->userdata = released;
+                released = u;
+            }
+        }
+        retained_ = 0;
+    }
+
+    // Освобождение идёт без блокировки: базовый распределитель может быть медленным
+    while (released) {
+        cv::UMatData* next = static_cast<cv::UMatData*>(released->userdata);
+        released->userdata = nullptr;
+        released->currAllocator = released->prevAllocator = base_;
+        base_->deallocate(released);
+        released = next;
+    }
+}
+
+int64_t BufferPool::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+int64_t BufferPool::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+size_t BufferPool::retainedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retained_;
+}
+
+BufferPool* installBufferPool(size_t maxRetainedBytes) {
+    // Пул не удаляется: cv::Mat из него могут освобождаться вплоть до выхода из процесса
+    BufferPool* pool = new BufferPool(cv::Mat::getDefaultAllocator(), maxRetainedBytes);
+    cv::Mat::setDefaultAllocator(pool);
+    return pool;
+}
+
+void printBufferPoolStats(const BufferPool* pool) {
+    if (!pool) return;
+    std::cout << "Buffer pool: " << pool->hits() << " reused, " << pool->misses() << " allocated, "
+              << (pool->retainedBytes() >> 20) << " MB retained" << std::endl;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Пул буферов cv::Mat по классам размеров: освобождённый буфер вместе с его UMatData
+// остаётся в списке своего класса и отдаётся следующему create подходящего размера.
+// Классы идут с шагом в четверть степени двойки, поэтому буфер больше запроса не более
+// чем на 25%, а изображения близких размеров переиспользуют одни и те же буферы.
+// Промахи и освобождение сверх бюджета уходят в базовый распределитель.
+// Пул должен жить дольше всех cv::Mat, выделенных через него
+class BufferPool : public cv::MatAllocator {
+public:
+    BufferPool(cv::MatAllocator* base, size_t maxRetainedBytes);
+    ~BufferPool() override;
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* u, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* u) const override;
+
+    // Возврат всех свободных буферов базовому распределителю
+    void trim() const;
+
+    int64_t hits() const;
+    int64_t misses() const;
+    size_t retainedBytes() const;
+
+private:
+    static const int kClasses = 4 * 64;
+
+    cv::MatAllocator* base_;
+    size_t budget_;
+    mutable std::mutex mutex_;
+    mutable cv::UMatData* free_[kClasses] = {}; // списки через UMatData::userdata
+    mutable size_t retained_ = 0;
+    mutable int64_t hits_ = 0;
+    mutable int64_t misses_ = 0;
+};
+
+// Пул поверх текущего распределителя по умолчанию становится распределителем всех cv::Mat
+// до конца процесса. После traceStart трассировка считает только промахи пула
+BufferPool* installBufferPool(size_t maxRetainedBytes);
+
+// Строка со счётчиками пула в std::cout; без пула ничего не делает
+void printBufferPoolStats(const BufferPool* pool);
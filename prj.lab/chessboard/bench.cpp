@@ -0,0 +1,60 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "chessboard.hpp"
+
+// Среднее время одного вызова в миллисекундах
+template <typename Fn>
+double measure(int iterations, Fn fn) {
+    cv::TickMeter timer;
+    for (int it = 0; it < iterations; ++it) {
+        timer.start();
+        fn();
+        timer.stop();
+    }
+    return timer.getTimeMilli() / iterations;
+}
+
+int main(int argc, char** argv) {
+    int iterations = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            iterations = std::stoi(argv[++i]);
+        }
+    }
+
+    // Разрешения от VGA до 8K и несколько размеров клетки
+    std::vector<cv::Size> sizes = {
+        {640, 480}, {1920, 1080}, {3840, 2160}, {7680, 4320}
+    };
+    std::vector<int> cellSizes = {1, 10, 64};
+
+    cv::RNG rng(12345);
+    bool all_equal = true;
+    for (const auto& size : sizes) {
+        cv::Mat image(size, CV_8UC3);
+        rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+
+        for (int cellSize : cellSizes) {
+            cv::Mat reference, fused;
+            double chain_ms = measure(iterations, [&] { flipInvertChessboardReference(image, reference, cellSize); });
+            double fused_ms = measure(iterations, [&] { flipInvertChessboard(image, fused, cellSize); });
+
+            bool equal = cv::norm(reference, fused, cv::NORM_INF) == 0;
+            all_equal = all_equal && equal;
+
+            double mpix = size.area() / 1e6;
+            std::cout << size.width << "x" << size.height << " SIZE=" << cellSize
+                      << "  chain: " << chain_ms << " ms (" << mpix / chain_ms * 1e3 << " MPix/s)"
+                      << "  fused: " << fused_ms << " ms (" << mpix / fused_ms * 1e3 << " MPix/s)"
+                      << "  speedup: " << chain_ms / fused_ms
+                      << (equal ? "  [identical]" : "  [MISMATCH]") << std::endl;
+        }
+    }
+
+    return all_equal ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "chessboard.hpp"
+
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// dst = ~src & mask для одной строки, по 16 байт за инструкцию
+void invertMaskRow(const uchar* src, const uchar* mask, uchar* dst, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_andnot_si128(s, m));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= n; i += 16) {
+        vst1q_u8(dst + i, vbicq_u8(vld1q_u8(mask + i), vld1q_u8(src + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = static_cast<uchar>(~src[i] & mask[i]);
+    }
+}
+
+}
+
+void flipInvertChessboard(const cv::Mat& src, cv::Mat& dst, int cellSize) {
+    CV_Assert(src.depth() == CV_8U && cellSize > 0);
+
+    // Переворот не работает на месте: при совпадении буферов читаем из копии
+    cv::Mat input = (src.data == dst.data) ? src.clone() : src;
+    dst.create(input.size(), input.type());
+
+    int cn = input.channels();
+    int width = input.cols * cn;
+
+    // Две фазы строки маски: строки клеток с чётным и нечётным номером.
+    // Клетка белая, если (x / SIZE) % 2 == (y / SIZE) % 2
+    std::vector<uchar> patterns(2 * static_cast<size_t>(width));
+    for (int x = 0; x < input.cols; ++x) {
+        uchar on = (x / cellSize) % 2 == 0 ? 255 : 0;
+        for (int c = 0; c < cn; ++c) {
+            patterns[x * cn + c] = on;
+            patterns[width + x * cn + c] = static_cast<uchar>(~on);
+        }
+    }
+
+    cv::parallel_for_(cv::Range(0, input.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const uchar* mask = patterns.data() + ((y / cellSize) % 2) * static_cast<size_t>(width);
+            invertMaskRow(input.ptr<uchar>(input.rows - 1 - y), mask, dst.ptr<uchar>(y), width);
+        }
+    });
+}
+
+void flipInvertChessboardReference(const cv::Mat& src, cv::Mat& dst, int cellSize) {
+    // Переворачиваем изображение
+    cv::Mat flippedImage;
+    cv::flip(src, flippedImage, 0);
+
+    // Инвертируем цвета изображения
+    cv::Mat invertedImage;
+    cv::bitwise_not(flippedImage, invertedImage);
+
+    // Создание шахматной маски того же размера, что и изображение
+    cv::Mat mask = cv::Mat::zeros(invertedImage.rows, invertedImage.cols, CV_8UC1);
+    for(int y = 0; y < mask.rows; ++y) {
+        for(int x = 0; x < mask.cols; ++x) {
+            if((x / cellSize) % 2 == (y / cellSize) % 2) {
+                mask.at<uchar>(y, x) = 255;
+            }
+        }
+    }
+
+    // Преобразуем маску из одного канала в число каналов изображения
+    cv::Mat maskColor;
+    if (src.channels() == 3) {
+        cv::cvtColor(mask, maskColor, cv::COLOR_GRAY2BGR);
+    } else {
+        cv::merge(std::vector<cv::Mat>(src.channels(), mask), maskColor);
+    }
+
+    // Применяем маску через побитовое И к инвертированному изображению
+    cv::bitwise_and(invertedImage, maskColor, dst);
+}
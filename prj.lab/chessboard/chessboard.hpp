@@ -0,0 +1,11 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+// Переворот по вертикали, инверсия цветов и шахматная маска за один проход по памяти.
+// Каждая строка источника читается один раз, результат пишется сразу в dst;
+// маска вычисляется по координатам и не хранится как изображение. Поддерживается CV_8UC(n)
+void flipInvertChessboard(const cv::Mat& src, cv::Mat& dst, int cellSize);
+
+// Эталонная цепочка flip -> bitwise_not -> маска -> cvtColor -> bitwise_and, оставлена для сравнения
+void flipInvertChessboardReference(const cv::Mat& src, cv::Mat& dst, int cellSize);
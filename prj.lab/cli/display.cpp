@@ -0,0 +1,30 @@
+#include "display.hpp"
+
+#include <iostream>
+
+#ifdef MISIS_WITH_DISPLAY
+#include <opencv2/highgui.hpp>
+#endif
+
+bool displayAvailable() {
+#ifdef MISIS_WITH_DISPLAY
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool showImages(const std::vector<std::pair<std::string, cv::Mat>>& windows) {
+#ifdef MISIS_WITH_DISPLAY
+    for (const auto& window : windows) {
+        cv::namedWindow(window.first, cv::WINDOW_NORMAL);
+        cv::imshow(window.first, window.second);
+    }
+    cv::waitKey(0);
+    return true;
+#else
+    (void)windows;
+    std::cout << "Built without display support, reconfigure with -DMISIS_WITH_DISPLAY=ON" << std::endl;
+    return false;
+#endif
+}
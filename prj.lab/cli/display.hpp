@@ -0,0 +1,14 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Необязательная стадия показа результатов. HighGUI собирается и линкуется только при
+// -DMISIS_WITH_DISPLAY=ON; по умолчанию инструменты работают без дисплея и без HighGUI
+bool displayAvailable();
+
+// Окна (заголовок, изображение) и ожидание нажатия клавиши.
+// Возвращает false, если сборка без показа
+bool showImages(const std::vector<std::pair<std::string, cv::Mat>>& windows);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// Экранирование строки для значения JSON: кавычки, обратная косая черта и управляющие
+// символы (табуляция, перевод строки и остальные < 0x20). Байты UTF-8 передаются как есть
+std::string jsonEscape(const std::string& text);
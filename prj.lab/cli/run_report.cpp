@@ -0,0 +1,63 @@
+#include "run_report.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "json.hpp"
+
+namespace {
+
+const char* statusName(int code) {
+    switch (code) {
+    case kExitOk: return "ok";
+    case kExitPartial: return "partial";
+    case kExitUsage: return "usage";
+    case kExitInput: return "input_error";
+    case kExitOutput: return "output_error";
+    default: return "error";
+    }
+}
+
+}
+
+RunReport::RunReport(const std::string& tool) : tool_(tool), start_(std::chrono::steady_clock::now()) {}
+
+void RunReport::setPath(const std::string& path) {
+    path_ = path;
+}
+
+void RunReport::set(const std::string& key, const std::string& value) {
+    fields_.emplace_back(key, "\"" + jsonEscape(value) + "\"");
+}
+
+void RunReport::set(const std::string& key, double value) {
+    std::ostringstream out;
+    out << value;
+    fields_.emplace_back(key, out.str());
+}
+
+int RunReport::finish(int code) {
+    if (path_.empty()) return code;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    std::ostringstream json;
+    json << "{\"tool\":\"" << jsonEscape(tool_) << "\",\"exit_code\":" << code
+         << ",\"status\":\"" << statusName(code) << "\",\"seconds\":" << seconds;
+    for (const auto& field : fields_) {
+        json << ",\"" << jsonEscape(field.first) << "\":" << field.second;
+    }
+    json << "}";
+
+    if (path_ == "-") {
+        std::cout << json.str() << std::endl;
+        return code;
+    }
+    std::ofstream file(path_);
+    file << json.str() << "\n";
+    if (!file) {
+        std::cout << "Could not write report " << path_ << std::endl;
+        return code == kExitOk ? kExitOutput : code;
+    }
+    return code;
+}
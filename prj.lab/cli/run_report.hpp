@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Коды завершения всех инструментов
+enum ExitCode {
+    kExitOk = 0,       // всё обработано
+    kExitPartial = 1,  // часть входов не обработана
+    kExitUsage = 2,    // неверные аргументы
+    kExitInput = 3,    // вход не прочитан
+    kExitOutput = 4    // результат не записан
+};
+
+// Итог запуска для машин без дисплея: один JSON-объект
+// {"tool", "exit_code", "status", "seconds", поля set()} в файл -report <файл>
+// или последней строкой в std::cout при -report -. Без пути отчёт не пишется
+class RunReport {
+public:
+    explicit RunReport(const std::string& tool);
+
+    void setPath(const std::string& path);
+    void set(const std::string& key, const std::string& value);
+    void set(const std::string& key, double value);
+
+    // Запись отчёта; возвращает code, чтобы main мог сразу вернуть его
+    int finish(int code);
+
+private:
+    std::string tool_;
+    std::string path_;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<std::pair<std::string, std::string>> fields_; // значения уже в записи JSON
+};
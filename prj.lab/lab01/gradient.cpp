@@ -0,0 +1,42 @@
+#include "gradient.hpp"
+
+#include <cstring>
+
+#include "pointops.hpp"
+
+cv::Mat applyGammaCorrection(const cv::Mat& img, double gamma) {
+    cv::Mat result;
+    applyGammaCorrection(img, gamma, result);
+    return result;
+}
+
+void applyGammaCorrection(const cv::Mat& img, double gamma, cv::Mat& result) {
+    // Глубина сохраняется: для 8 и 16 бит таблица строится один раз на значение gamma
+    // и берётся из кэша, float считается векторизованным приближением pow
+    applyGamma(img, gamma, result);
+}
+
+cv::Mat generateGradient(int s, int h, double gamma) {
+    cv::Mat result;
+    generateGradient(s, h, gamma, result);
+    return result;
+}
+
+void generateGradient(int s, int h, double gamma, cv::Mat& result) {
+    int length = 256 * h;
+    cv::Mat plain(1, length, CV_8UC1);
+    uchar* values = plain.ptr<uchar>();
+    for (int i = 0; i < length; ++i) {
+        values[i] = static_cast<uchar>((i * 255.0) / (length - 1));
+    }
+    cv::Mat corrected;
+    applyGammaCorrection(plain, gamma, corrected);
+
+    result.create(s * 2, length, CV_8UC1);
+    cv::parallel_for_(cv::Range(0, result.rows), [&](const cv::Range& range) {
+        for (int r = range.start; r < range.end; ++r) {
+            const cv::Mat& pattern = r < s ? plain : corrected;
+            std::memcpy(result.ptr<uchar>(r), pattern.ptr<uchar>(), length);
+        }
+    });
+}
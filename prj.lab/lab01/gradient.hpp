@@ -0,0 +1,20 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+// Функция для гамма-коррекции изображения CV_8U, CV_16U или CV_32F (значения в [0, 1]) с сохранением глубины;
+// gamma > 0
+cv::Mat applyGammaCorrection(const cv::Mat& img, double gamma);
+
+// То же в заданный буфер; result того же размера переиспользуется, result может совпадать с img
+void applyGammaCorrection(const cv::Mat& img, double gamma, cv::Mat& result);
+
+// Функция для построения градиента сразу в итоговой раскладке.
+// Поворот на 90° по часовой и отражение по горизонтали вместе дают транспонирование,
+// поэтому первые s строк результата — градиент, а следующие s — он же после гамма-коррекции.
+// Строки заполняются копированием готового шаблона параллельно, в единственный буфер
+cv::Mat generateGradient(int s, int h, double gamma);
+
+// То же в заданный буфер: если result уже 2s x 256h CV_8UC1 (например, отображённый файл),
+// градиент пишется прямо в него без выделения памяти
+void generateGradient(int s, int h, double gamma, cv::Mat& result);
@@ -1,21 +1,13 @@
-#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
 #include <iostream>
 #include <string>
 
-// Функция для гамма-коррекции трехканального изображения
-cv::Mat applyGammaCorrection(const cv::Mat& img, double gamma) {
-    CV_Assert(img.depth() == CV_8U); // Проверяем, что глубина изображения равна 8 бит на канал
-
-    cv::Mat lut(1, 256, CV_8UC1);
-    for (int i = 0; i < 256; ++i) {
-        lut.at<uchar>(i) = cv::saturate_cast<uchar>(pow(i / 255.0, gamma) * 255.0);
-    }
-
-    cv::Mat result;
-    cv::LUT(img, lut, result); // Применяем LUT к изображению
-
-    return result;
-}
+#include "display.hpp"
+#include "gradient.hpp"
+#include "mapped_image.hpp"
+#include "run_report.hpp"
+#include "trace.hpp"
 
 int main(int argc, char** argv) {
     int s = 3, h = 50; // значения по умолчанию
@@ -23,6 +15,9 @@ int main(int argc, char** argv) {
     h*=10;
     double gamma = 2.4;
     std::string outputFilename = "output.png"; // значение по умолчанию
+    std::string tracePath; // -trace <файл>: этапы в формате Chrome trace JSON
+    bool show = false; // -show: окно с результатом (только в сборке с MISIS_WITH_DISPLAY)
+    RunReport report("gradient"); // -report <файл или ->: итог запуска в JSON
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -32,41 +27,58 @@ int main(int argc, char** argv) {
             h = std::stoi(argv[++i]);
         } else if (arg == "-gamma" && i + 1 < argc) {
             gamma = std::stod(argv[++i]);
+        } else if (arg == "-trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "-show") {
+            show = true;
+        } else if (arg == "-report" && i + 1 < argc) {
+            report.setPath(argv[++i]);
         } else {
             outputFilename = arg;
         }
     }
-
-    int rows = 256 * h;
-    bool colorless = false;
-    cv::Mat img(rows, s * 2, CV_8UC1); // Создаем изображение в два раза ширеp
-    // Создание градиентной полосы без гамма-коррекции
-    for (int i = 0; i < img.rows; ++i) {
-        uchar value = static_cast<uchar>((i * 255.0) / (rows - 1));
-        for (int j = 0; j < img.cols / 2; ++j) { // Заполняем только первую половину ширины
-            img.at<uchar>(i, j) = value;
-        }
+    if (s <= 0 || h <= 0 || gamma <= 0) {
+        std::cout << "Usage: -s <rows> -h <column width> -gamma <value> [output] [-show] [-trace <file>] [-report <file>]"
+                  << std::endl;
+        return report.finish(kExitUsage);
     }
+    report.set("output", outputFilename);
+    report.set("width", 256 * h);
+    report.set("height", 2 * s);
+    report.set("gamma", gamma);
 
-    // Создание градиентной полосы с гамма-коррекцией
-    cv::Mat halfImg = img.colRange(0, s);
-    cv::Mat correctedHalfImg = applyGammaCorrection(halfImg, gamma);
-    correctedHalfImg.copyTo(img.colRange(s, s * 2)); // Копируем обработанную половину во вторую половину ширины исходного изображения
+    if (!tracePath.empty()) {
+        traceStart(tracePath);
+    }
 
-    cv::Mat rotatedImg;
-    cv::rotate(img, rotatedImg, cv::ROTATE_90_CLOCKWISE);
+    // PGM/raw-файл результата создаётся заранее и отображается в память:
+    // градиент пишется прямо в файл, без буфера и кодирования
+    MappedImage mapped;
+    bool inFile = isMappableImage(outputFilename) && mapped.create(outputFilename, 2 * s, 256 * h, CV_8UC1);
 
-    // Переворачиваем изображение
-    cv::Mat flippedImage;
-    cv::flip(rotatedImg, flippedImage, 1);
+    // Градиент строится сразу в итоговой раскладке, без промежуточных копий
+    cv::Mat gradient;
+    {
+        TraceScope scope("gradient");
+        if (inFile) {
+            gradient = mapped.mat();
+        }
+        generateGradient(s, h, gamma, gradient);
+    }
 
-    // Сохранение или отображение результата
-    if (!outputFilename.empty()) {
-        cv::imwrite(outputFilename, flippedImage);
-    } else {
-        cv::imshow("Gradient Original and Gamma Corrected Rotated", flippedImage);
-        cv::waitKey(0);
+    // Сохранение и, по запросу, отображение результата
+    bool written = true;
+    if (!inFile) {
+        TraceScope scope("encode", outputFilename);
+        written = cv::imwrite(outputFilename, gradient);
+    }
+    if (!written) {
+        std::cout << "Could not write " << outputFilename << std::endl;
+    }
+    if (show) {
+        showImages({{"Gradient Original and Gamma Corrected Rotated", gradient}});
     }
+    traceFinish();
 
-    return 0;
+    return report.finish(written ? kExitOk : kExitOutput);
 }
@@ -0,0 +1,238 @@
+#include "experiment.hpp"
+
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+#include "noise.hpp"
+#include "trace.hpp"
+
+namespace {
+
+const int kHistSize = 256; // сторона изображения гистограммы
+const int kParts = 3;
+
+// Размеры фигур тестового изображения пропорциональны исходным 209 и 83 при стороне 256
+int innerSquareSide(int side) { return cvRound(side * 209.0 / 256.0); }
+int circleRadius(int side) { return cvRound(side * 83.0 / 256.0); }
+
+// Статистики трёх частей гистограммы одной ячейки
+void appendPartStats(const HistogramStats& histogram, int side, const std::vector<uchar>& levels,
+                     double stddev, PartStats* out) {
+    int part_size = HistogramStats::kBins / kParts;
+    for (int part = 0; part < kParts; ++part) {
+        int begin = part * part_size;
+        int end = (part < kParts - 1) ? begin + part_size : HistogramStats::kBins;
+
+        PartStats& row = out[part];
+        row.side = side;
+        row.levels = levels;
+        row.stddev = stddev;
+        row.part = part;
+        row.mean_index = histogram.segmentMeanIndex(begin, end);
+        row.variance = histogram.segmentCountVariance(begin, end);
+    }
+}
+
+}
+
+cv::Mat generate_test_image(int side, int inner_square_side, int circle_radius, const std::vector<uchar>& levels) {
+    cv::Mat image = cv::Mat::zeros(side, side, CV_8UC1);
+
+    // Outer square
+    image.setTo(levels[0]);
+
+    // Inner square
+    cv::Point inner_square_top_left((side - inner_square_side) / 2, (side - inner_square_side) / 2);
+    cv::rectangle(image, inner_square_top_left, inner_square_top_left + cv::Point(inner_square_side, inner_square_side), levels[1], cv::FILLED);
+
+    // Circle
+    cv::circle(image, cv::Point(side / 2, side / 2), circle_radius, levels[2], cv::FILLED);
+
+    return image;
+}
+
+void draw_histogram(const HistogramStats& stats, cv::Mat& histImage) {
+    int histSize = HistogramStats::kBins; // Количество бинов
+
+    // Размеры изображения гистограммы
+    int hist_w = kHistSize;
+    int hist_h = kHistSize;
+    CV_Assert(histImage.rows == hist_h && histImage.cols == hist_w && histImage.type() == CV_8UC1);
+    histImage.setTo(cv::Scalar(230));
+
+    // Нормализация гистограммы так, чтобы максимальное значение соответствовало 230 пикселям
+    float scale = static_cast<float>(230.0 / stats.maxCount());
+
+    // Отрисовка гистограммы
+    for(int i = 1; i < histSize; i++) {
+        cv::line(histImage,
+                 cv::Point(i, hist_h),
+                 cv::Point(i, hist_h - cvRound(static_cast<float>(stats.count(i)) * scale)),
+                 cv::Scalar(0),
+                 1);
+    }
+
+    // Разбиваем гистограмму на три части и вычисляем средний индекс для каждой части
+    int part_size = histSize / kParts;
+    for (int part = 0; part < kParts; ++part) {
+        int begin = part * part_size;
+        int end = (part < kParts - 1) ? begin + part_size : histSize;
+        double mean_index = stats.segmentMeanIndex(begin, end);
+
+        // Отрисовка линии среднего индекса для каждой части
+        int line_position = cvRound(mean_index);
+        cv::line(histImage, cv::Point(line_position, 0), cv::Point(line_position, hist_h), cv::Scalar(0), 2);
+    }
+}
+
+cv::Mat draw_histogram(const HistogramStats& stats) {
+    cv::Mat histImage(kHistSize, kHistSize, CV_8UC1);
+    draw_histogram(stats, histImage);
+    return histImage;
+}
+
+bool loadExperimentConfig(const std::string& path, ExperimentGrid& grid) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) return false;
+
+    cv::FileNode levels = fs["levels"];
+    if (!levels.empty()) {
+        grid.levels.clear();
+        for (cv::FileNodeIterator it = levels.begin(); it != levels.end(); ++it) {
+            std::vector<int> values;
+            *it >> values;
+            if (values.size() != 3) return false;
+            grid.levels.push_back({cv::saturate_cast<uchar>(values[0]), cv::saturate_cast<uchar>(values[1]),
+                                   cv::saturate_cast<uchar>(values[2])});
+        }
+    }
+    if (!fs["stddev"].empty()) {
+        fs["stddev"] >> grid.stddevs;
+    }
+    if (!fs["sizes"].empty()) {
+        fs["sizes"] >> grid.sizes;
+    }
+    if (!fs["seed"].empty()) {
+        grid.seed = static_cast<uint64_t>(static_cast<int>(fs["seed"]));
+    }
+    return true;
+}
+
+ExperimentResult runExperiment(const ExperimentGrid& grid) {
+    int n_levels = static_cast<int>(grid.levels.size());
+    int n_stddev = static_cast<int>(grid.stddevs.size());
+    int n_sizes = static_cast<int>(grid.sizes.size());
+
+    // Мозаики выделяются один раз целиком вместо цепочки hconcat/vconcat.
+    // Ширина столбца — наибольшая из стороны изображения и ширины гистограммы
+    ExperimentResult result;
+    std::vector<std::vector<cv::Mat>> clean(n_sizes);
+    for (int s = 0; s < n_sizes; ++s) {
+        int side = grid.sizes[s];
+        int column = std::max(side, kHistSize);
+        result.mosaics.push_back(cv::Mat::zeros(side + n_stddev * (side + kHistSize), n_levels * column, CV_8UC1));
+        for (int l = 0; l < n_levels; ++l) {
+            clean[s].push_back(generate_test_image(side, innerSquareSide(side), circleRadius(side), grid.levels[l]));
+        }
+    }
+
+    // Ячейка — (размер, уровни, шум); шум с номером 0 — исходное изображение без шума
+    int cells_per_level = n_stddev + 1;
+    int cells = n_sizes * n_levels * cells_per_level;
+    result.stats.resize(static_cast<size_t>(cells) * kParts);
+
+    // Область зашумлённого изображения вместе с гистограммой под ним
+    auto noisyBlock = [&](int cell) {
+        int s = cell / (n_levels * cells_per_level);
+        int l = (cell / cells_per_level) % n_levels;
+        int k = cell % cells_per_level;
+        int side = grid.sizes[s];
+        int column = std::max(side, kHistSize);
+        return cv::Rect(l * column, side + (k - 1) * (side + kHistSize), column, side + kHistSize);
+    };
+
+    // Повторы в сетке (одинаковые наборы уровней или значения stddev) зашумляются один раз:
+    // ячейка с тем же (размер, уровни, stddev) берёт результат первой такой ячейки
+    std::vector<int> source(cells);
+    std::map<std::tuple<int, std::vector<uchar>, double>, int> first;
+    for (int cell = 0; cell < cells; ++cell) {
+        int k = cell % cells_per_level;
+        source[cell] = cell;
+        if (k > 0) {
+            int s = cell / (n_levels * cells_per_level);
+            int l = (cell / cells_per_level) % n_levels;
+            source[cell] = first.emplace(std::make_tuple(s, grid.levels[l], grid.stddevs[k - 1]), cell).first->second;
+        }
+    }
+
+    // Число полос равно числу ячеек: свободный поток берёт следующую ячейку,
+    // так что медленные ячейки не задерживают остальные
+    cv::parallel_for_(cv::Range(0, cells), [&](const cv::Range& range) {
+        for (int cell = range.start; cell < range.end; ++cell) {
+            int s = cell / (n_levels * cells_per_level);
+            int l = (cell / cells_per_level) % n_levels;
+            int k = cell % cells_per_level;
+
+            int side = grid.sizes[s];
+            int column = std::max(side, kHistSize);
+            cv::Mat& mosaic = result.mosaics[s];
+            const cv::Mat& image = clean[s][l];
+            PartStats* stats = &result.stats[static_cast<size_t>(cell) * kParts];
+
+            if (k == 0) {
+                image.copyTo(mosaic(cv::Rect(l * column, 0, side, side)));
+                appendPartStats(HistogramStats(image), side, grid.levels[l], 0, stats);
+                continue;
+            }
+
+            if (source[cell] != cell) continue;
+            double stddev = grid.stddevs[k - 1];
+            std::string detail = traceEnabled() ? cv::format("side %d, levels %d, stddev %g", side, l, stddev)
+                                                : std::string();
+            // Область нужного размера и типа, поэтому add_noise пишет прямо в мозаику
+            int top = side + (k - 1) * (side + kHistSize);
+            cv::Mat noisy = mosaic(cv::Rect(l * column, top, side, side));
+            {
+                TraceScope scope("noise", detail);
+                add_noise(image, stddev, grid.seed, noisy);
+            }
+            HistogramStats histogram(noisy);
+            {
+                TraceScope scope("histogram", detail);
+                cv::Mat histImage = mosaic(cv::Rect(l * column, top + side, kHistSize, kHistSize));
+                draw_histogram(histogram, histImage);
+            }
+            TraceScope scope("stats", detail);
+            appendPartStats(histogram, side, grid.levels[l], stddev, stats);
+        }
+    }, cells);
+
+    for (int cell = 0; cell < cells; ++cell) {
+        int from = source[cell];
+        if (from == cell) continue;
+        cv::Mat& mosaic = result.mosaics[cell / (n_levels * cells_per_level)];
+        mosaic(noisyBlock(from)).copyTo(mosaic(noisyBlock(cell)));
+        std::copy_n(&result.stats[static_cast<size_t>(from) * kParts], kParts,
+                    &result.stats[static_cast<size_t>(cell) * kParts]);
+    }
+
+    return result;
+}
+
+bool writeStatsCsv(const std::string& path, const std::vector<PartStats>& stats) {
+    std::ofstream csv(path);
+    if (!csv) return false;
+
+    csv << "side,levels,stddev,part,mean_index,variance\n";
+    for (const auto& row : stats) {
+        csv << row.side << ",";
+        for (size_t i = 0; i < row.levels.size(); ++i) {
+            csv << (i ? " " : "") << static_cast<int>(row.levels[i]);
+        }
+        csv << "," << row.stddev << "," << row.part << "," << row.mean_index << "," << row.variance << "\n";
+    }
+    return static_cast<bool>(csv);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "histogram_stats.hpp"
+
+// Function to generate the test image with three levels of brightness
+cv::Mat generate_test_image(int side, int inner_square_side, int circle_radius, const std::vector<uchar>& levels);
+
+// Function to draw the histogram of brightness into a 256x256 CV_8UC1 image (or ROI)
+void draw_histogram(const HistogramStats& stats, cv::Mat& histImage);
+cv::Mat draw_histogram(const HistogramStats& stats);
+
+// Сетка эксперимента: наборы уровней яркости x значения шума x размеры изображений
+struct ExperimentGrid {
+    std::vector<std::vector<uchar>> levels;
+    std::vector<double> stddevs;
+    std::vector<int> sizes;
+    uint64_t seed = 0;
+};
+
+// Чтение сетки из файла cv::FileStorage (YAML/JSON) с ключами levels, stddev, sizes, seed.
+// Отсутствующие ключи оставляют значения grid без изменений
+bool loadExperimentConfig(const std::string& path, ExperimentGrid& grid);
+
+// Среднее и дисперсия одной части гистограммы одной ячейки (stddev = 0 — исходное изображение)
+struct PartStats {
+    int side;
+    std::vector<uchar> levels;
+    double stddev;
+    int part;
+    double mean_index;
+    double variance;
+};
+
+// Результаты эксперимента: мозаика для каждого размера и таблица статистик
+struct ExperimentResult {
+    std::vector<cv::Mat> mosaics;
+    std::vector<PartStats> stats;
+};
+
+// Все ячейки сетки считаются параллельно; каждая ячейка рисуется сразу в свою область
+// заранее выделенной мозаики. Строка мозаики — исходные изображения, далее для каждого
+// stddev строка из зашумлённых изображений с гистограммами под ними.
+// Зашумлённое изображение строится прямо в своей области мозаики, и по нему же считается
+// гистограмма для отрисовки и статистик. Повторяющиеся в сетке ячейки зашумляются один раз
+ExperimentResult runExperiment(const ExperimentGrid& grid);
+
+// Таблица статистик в CSV: side,levels,stddev,part,mean_index,variance
+bool writeStatsCsv(const std::string& path, const std::vector<PartStats>& stats);
@@ -0,0 +1,107 @@
+#include "histogram_stats.hpp"
+
+#include <algorithm>
+
+const int HistogramStats::kBins;
+
+HistogramStats::HistogramStats()
+    : counts_(kBins, 0),
+      prefix_count_(kBins + 1), prefix_index_(kBins + 1),
+      prefix_index_sq_(kBins + 1), prefix_count_sq_(kBins + 1) {}
+
+HistogramStats::HistogramStats(const cv::Mat& src) : HistogramStats() {
+    addImage(src);
+}
+
+void HistogramStats::add(int value, int64_t count) {
+    counts_[value] += count;
+    total_ += count;
+    dirty_ = true;
+}
+
+void HistogramStats::remove(int value, int64_t count) {
+    add(value, -count);
+}
+
+void HistogramStats::addImage(const cv::Mat& src) {
+    changeImage(src, 1);
+}
+
+void HistogramStats::removeImage(const cv::Mat& src) {
+    changeImage(src, -1);
+}
+
+void HistogramStats::clear() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_ = 0;
+    dirty_ = true;
+}
+
+void HistogramStats::changeImage(const cv::Mat& src, int64_t sign) {
+    CV_Assert(src.depth() == CV_8U);
+
+    // Подсчёт в локальный массив за один проход, затем перенос в общую гистограмму
+    int64_t local[kBins] = {0};
+    int n = src.cols * src.channels();
+    for (int i = 0; i < src.rows; ++i) {
+        const uchar* row = src.ptr<uchar>(i);
+        for (int j = 0; j < n; ++j) {
+            ++local[row[j]];
+        }
+    }
+
+    for (int b = 0; b < kBins; ++b) {
+        counts_[b] += sign * local[b];
+    }
+    total_ += sign * static_cast<int64_t>(src.total()) * src.channels();
+    dirty_ = true;
+}
+
+int64_t HistogramStats::maxCount() const {
+    return *std::max_element(counts_.begin(), counts_.end());
+}
+
+void HistogramStats::update() const {
+    if (!dirty_) return;
+    for (int b = 0; b < kBins; ++b) {
+        double c = static_cast<double>(counts_[b]);
+        prefix_count_[b + 1] = prefix_count_[b] + c;
+        prefix_index_[b + 1] = prefix_index_[b] + b * c;
+        prefix_index_sq_[b + 1] = prefix_index_sq_[b] + static_cast<double>(b) * b * c;
+        prefix_count_sq_[b + 1] = prefix_count_sq_[b] + c * c;
+    }
+    dirty_ = false;
+}
+
+int64_t HistogramStats::segmentTotal(int begin, int end) const {
+    update();
+    return static_cast<int64_t>(prefix_count_[end] - prefix_count_[begin]);
+}
+
+double HistogramStats::segmentMeanIndex(int begin, int end) const {
+    update();
+    double weight = prefix_count_[end] - prefix_count_[begin];
+    if (weight <= 0) return begin;
+    return (prefix_index_[end] - prefix_index_[begin]) / weight;
+}
+
+double HistogramStats::segmentIndexVariance(int begin, int end) const {
+    update();
+    double weight = prefix_count_[end] - prefix_count_[begin];
+    if (weight <= 0) return 0;
+    double mean = (prefix_index_[end] - prefix_index_[begin]) / weight;
+    return (prefix_index_sq_[end] - prefix_index_sq_[begin]) / weight - mean * mean;
+}
+
+double HistogramStats::segmentMeanCount(int begin, int end) const {
+    update();
+    return (prefix_count_[end] - prefix_count_[begin]) / (end - begin);
+}
+
+double HistogramStats::segmentCountVariance(int begin, int end) const {
+    update();
+    double n = end - begin;
+    double sum = prefix_count_[end] - prefix_count_[begin];
+    double sum_sq = prefix_count_sq_[end] - prefix_count_sq_[begin];
+    return (sum_sq - sum * sum / n) / n;
+}
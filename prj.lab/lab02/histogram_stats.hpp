@@ -0,0 +1,54 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+// Гистограмма яркости 8-битного изображения со статистиками по отрезкам бинов.
+// Гистограмма считается за один проход с целочисленными счётчиками; запросы отвечают
+// за O(1) по префиксным суммам, которые перестраиваются при первом запросе после add/remove.
+// Добавление и удаление отсчётов позволяет вести скользящее окно по кадрам видео
+class HistogramStats {
+public:
+    static const int kBins = 256;
+
+    HistogramStats();
+    explicit HistogramStats(const cv::Mat& src);
+
+    // Изменение гистограммы: отдельные значения или все пиксели изображения CV_8U
+    void add(int value, int64_t count = 1);
+    void remove(int value, int64_t count = 1);
+    void addImage(const cv::Mat& src);
+    void removeImage(const cv::Mat& src);
+    void clear();
+
+    int64_t count(int bin) const { return counts_[bin]; }
+    int64_t total() const { return total_; }
+    int64_t maxCount() const;
+
+    // Запросы по отрезку бинов [begin, end)
+    int64_t segmentTotal(int begin, int end) const;
+    // Средний индекс бина, взвешенный счётчиками; для пустого отрезка — begin
+    double segmentMeanIndex(int begin, int end) const;
+    // Дисперсия яркости отсчётов, попавших в отрезок
+    double segmentIndexVariance(int begin, int end) const;
+    // Среднее и дисперсия значений бинов (самих счётчиков) на отрезке
+    double segmentMeanCount(int begin, int end) const;
+    double segmentCountVariance(int begin, int end) const;
+
+private:
+    void changeImage(const cv::Mat& src, int64_t sign);
+    void update() const;
+
+    std::vector<int64_t> counts_;
+    int64_t total_ = 0;
+
+    // Префиксные суммы по бинам [0, k): sum(c), sum(b * c), sum(b^2 * c), sum(c^2).
+    // Перестраиваются лениво, поэтому одновременные запросы из разных потоков
+    // допустимы только после первого запроса
+    mutable bool dirty_ = true;
+    mutable std::vector<double> prefix_count_;
+    mutable std::vector<double> prefix_index_;
+    mutable std::vector<double> prefix_index_sq_;
+    mutable std::vector<double> prefix_count_sq_;
+};
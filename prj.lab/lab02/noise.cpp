@@ -0,0 +1,131 @@
+#include "noise.hpp"
+
+#include <opencv2/imgproc.hpp>
+#include <random>
+
+namespace {
+
+const uint64_t kGoldenGamma = 0x9E3779B97F4A7C15ull;
+
+// SplitMix64: 64 случайных бита для шага counter потока с ключом key.
+// Любой отсчёт вычисляется независимо, поэтому потоки можно делить как угодно
+inline uint64_t counterBits(uint64_t key, uint64_t counter) {
+    uint64_t x = key + counter * kGoldenGamma;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Зашумление одной строки из n отсчётов. Пара отсчётов получает два значения
+// одного преобразования Бокса–Мюллера; логарифм, корень и sin/cos считают
+// векторизованные функции OpenCV над буферами строки.
+// Строка всегда обрабатывается целиком, поэтому результат не зависит от разбиения на потоки.
+// T — тип отсчёта источника и результата: uchar, ushort или float
+template <typename T>
+void noisyRow(const T* src, T* dst, int n, uint64_t key, uint64_t firstPair, float variance,
+              cv::Mat& radius, cv::Mat& angle, cv::Mat& x, cv::Mat& y, cv::Mat& sum) {
+    const float scale = 1.0f / 16777216.0f; // 2^-24
+    const float twoPi = 6.28318530717958647692f;
+    int pairs = radius.cols;
+
+    float* r = radius.ptr<float>();
+    float* a = angle.ptr<float>();
+    for (int k = 0; k < pairs; ++k) {
+        uint64_t bits = counterBits(key, firstPair + k);
+        r[k] = static_cast<float>((bits >> 40) + 1) * scale;           // (0, 1]
+        a[k] = static_cast<float>(bits & 0xFFFFFF) * scale * twoPi;     // [0, 2pi)
+    }
+
+    cv::log(radius, radius);
+    for (int k = 0; k < pairs; ++k) {
+        r[k] *= -2.0f * variance;
+    }
+    cv::sqrt(radius, radius);
+    cv::polarToCart(radius, angle, x, y);
+
+    // Сложение с исходными значениями; насыщение и округление целых — в convertTo,
+    // float не ограничивается
+    const float* zx = x.ptr<float>();
+    const float* zy = y.ptr<float>();
+    float* s = sum.ptr<float>();
+    for (int k = 0; k < pairs; ++k) {
+        s[2 * k] = src[2 * k] + zx[k];
+        if (2 * k + 1 < n) s[2 * k + 1] = src[2 * k + 1] + zy[k];
+    }
+
+    cv::Mat sumRow(1, n, CV_32F, s);
+    const int depth = cv::DataType<T>::depth;
+    cv::Mat dstRow(1, n, depth, dst);
+    sumRow.convertTo(dstRow, depth);
+}
+
+}
+
+cv::Mat add_noise(const cv::Mat& src, double stddev, uint64_t seed) {
+    cv::Mat result;
+    add_noise(src, stddev, seed, result);
+    return result;
+}
+
+void add_noise(const cv::Mat& src, double stddev, uint64_t seed, cv::Mat& dst) {
+    CV_Assert(src.depth() == CV_8U || src.depth() == CV_16U || src.depth() == CV_32F);
+
+    // Заголовок источника сохраняется до create, чтобы dst мог совпадать с src:
+    // каждая строка читается целиком до записи в неё
+    cv::Mat input = src;
+    dst.create(input.size(), input.type());
+    cv::Mat result = dst;
+    int n = input.cols * input.channels();
+    int pairs = (n + 1) / 2;
+    uint64_t key = counterBits(seed, 0);
+    float variance = static_cast<float>(stddev * stddev);
+
+    cv::parallel_for_(cv::Range(0, input.rows), [&](const cv::Range& range) {
+        // Буферы строки выделяются один раз на диапазон строк
+        cv::Mat radius(1, pairs, CV_32F), angle(1, pairs, CV_32F);
+        cv::Mat x(1, pairs, CV_32F), y(1, pairs, CV_32F), sum(1, 2 * pairs, CV_32F);
+        for (int i = range.start; i < range.end; ++i) {
+            uint64_t firstPair = static_cast<uint64_t>(i) * pairs;
+            switch (input.depth()) {
+            case CV_8U:
+                noisyRow(input.ptr<uchar>(i), result.ptr<uchar>(i), n, key, firstPair, variance,
+                         radius, angle, x, y, sum);
+                break;
+            case CV_16U:
+                noisyRow(input.ptr<ushort>(i), result.ptr<ushort>(i), n, key, firstPair, variance,
+                         radius, angle, x, y, sum);
+                break;
+            default:
+                noisyRow(input.ptr<float>(i), result.ptr<float>(i), n, key, firstPair, variance,
+                         radius, angle, x, y, sum);
+                break;
+            }
+        }
+    });
+}
+
+cv::Mat add_noise_reference(const cv::Mat& src, double stddev) {
+    cv::Mat noise = cv::Mat(src.size(), CV_32F);  // Use floating-point precision for noise
+    std::normal_distribution<float> dist(0, stddev);
+    std::default_random_engine generator;
+
+    // Generate noise
+    for (int i = 0; i < noise.rows; i++) {
+        for (int j = 0; j < noise.cols; j++) {
+            noise.at<float>(i, j) = dist(generator);
+        }
+    }
+
+    // Add noise to the original image
+    cv::Mat noisy_image;
+    src.convertTo(noisy_image, CV_32F);  // Convert src to float for addition
+    noisy_image += noise;  // Add the noise
+
+    // Clip the values to [0, 255] and convert back to uchar
+    cv::Mat clipped_noisy_image;
+    cv::threshold(noisy_image, clipped_noisy_image, 255, 255, cv::THRESH_TRUNC);
+    cv::threshold(clipped_noisy_image, clipped_noisy_image, 0, 0, cv::THRESH_TOZERO);
+    clipped_noisy_image.convertTo(clipped_noisy_image, CV_8U);
+
+    return clipped_noisy_image;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+// Function to add noise to the image.
+// Гауссов шум генерируется по счётчику (seed, номер отсчёта), поэтому результат
+// побитово воспроизводим для заданного seed при любом числе потоков.
+// Сложение, насыщение и преобразование к глубине источника выполняются за один проход по строке.
+// Вход CV_8U, CV_16U или CV_32F; stddev задаётся в единицах значений изображения,
+// целые результаты насыщаются, float не ограничивается
+cv::Mat add_noise(const cv::Mat& src, double stddev, uint64_t seed = 0);
+
+// То же в заданный буфер: dst того же размера и типа переиспользуется, dst может совпадать с src
+void add_noise(const cv::Mat& src, double stddev, uint64_t seed, cv::Mat& dst);
+
+// Исходная реализация через std::default_random_engine и промежуточные float-изображения
+cv::Mat add_noise_reference(const cv::Mat& src, double stddev);
@@ -0,0 +1,372 @@
+#include "autocontrast.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "pointops.hpp"
+
+namespace {
+
+// Индекс k-го элемента отсортированного массива из total пикселей, как в pixels[(int)(q * N)]
+uint64_t quantileIndex(double q, uint64_t total) {
+    double index = q * static_cast<double>(total);
+    if (index <= 0) return 0;
+    uint64_t k = static_cast<uint64_t>(index);
+    return std::min(k, total - 1);
+}
+
+// Наименьшее значение, у которого накопленный счётчик превышает k
+int valueAtIndex(const ChannelHistogram& hist, uint64_t k) {
+    uint64_t cumulative = 0;
+    for (size_t v = 0; v < hist.size(); ++v) {
+        cumulative += hist[v];
+        if (cumulative > k) return static_cast<int>(v);
+    }
+    return static_cast<int>(hist.size()) - 1;
+}
+
+// Бин гистограммы для отсчёта: целые — своим значением, float из [0, 1] — квантованием
+// на 65536 уровней, как у CV_16U
+inline int histogramBin(uchar v) { return v; }
+inline int histogramBin(ushort v) { return v; }
+inline int histogramBin(float v) { return cv::saturate_cast<ushort>(v * 65535.0f); }
+
+template <typename T>
+void accumulateRows(const cv::Mat& channel, ChannelHistogram& hist) {
+    uint64_t* counts = hist.data();
+    for (int i = 0; i < channel.rows; ++i) {
+        const T* row = channel.ptr<T>(i);
+        for (int j = 0; j < channel.cols; ++j) {
+            ++counts[histogramBin(row[j])];
+        }
+    }
+}
+
+// Счётчики всех каналов за один проход: T — тип отсчёта, CN — число каналов.
+// При step > 1 берётся каждая step-я строка и каждый step-й пиксель в ней, начиная с середины шага;
+// начало не выходит за последнюю строку и столбец, поэтому узкое изображение даёт хотя бы один отсчёт
+template <typename T, int CN>
+void accumulatePacked(const cv::Mat& image, int step, uint64_t* const* counts) {
+    int firstRow = std::min(step / 2, image.rows - 1);
+    int firstCol = std::min(step / 2, image.cols - 1);
+    for (int i = firstRow; i < image.rows; i += step) {
+        const T* row = image.ptr<T>(i) + firstCol * CN;
+        for (int j = firstCol; j < image.cols; j += step, row += step * CN) {
+            for (int c = 0; c < CN; ++c) {
+                ++counts[c][histogramBin(row[c])];
+            }
+        }
+    }
+}
+
+template <typename T>
+void dispatchPacked(const cv::Mat& image, int step, uint64_t* const* counts) {
+    switch (image.channels()) {
+    case 1: accumulatePacked<T, 1>(image, step, counts); break;
+    case 3: accumulatePacked<T, 3>(image, step, counts); break;
+    case 4: accumulatePacked<T, 4>(image, step, counts); break;
+    default: CV_Error(cv::Error::StsBadArg, "Only 1, 3 and 4 channel images are supported");
+    }
+}
+
+// Растяжение [lower, upper] -> [0, 1]; при lower == upper — ступенька
+inline float stretchUnit(float pixel, float lower, float upper) {
+    if (pixel <= lower) return 0;
+    if (pixel >= upper) return 1;
+    return (pixel - lower) / (upper - lower);
+}
+
+// Растяжение float-изображения по границам в бинах гистограммы (v * 65535) с результатом
+// типа D: uchar и ushort масштабируются к своему диапазону с насыщением, float остаётся в [0, 1]
+template <typename D, int CN>
+void stretchFloatRows(const cv::Mat& src, const std::vector<ContrastBounds>& bounds, cv::Mat& dst) {
+    const float scale = std::is_integral<D>::value ? static_cast<float>(std::numeric_limits<D>::max()) : 1.0f;
+    float lower[CN], upper[CN];
+    for (int c = 0; c < CN; ++c) {
+        lower[c] = bounds[c].lower;
+        upper[c] = bounds[c].upper;
+    }
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const float* in = src.ptr<float>(i);
+            D* out = dst.ptr<D>(i);
+            for (int j = 0; j < src.cols; ++j, in += CN, out += CN) {
+                for (int c = 0; c < CN; ++c) {
+                    out[c] = cv::saturate_cast<D>(stretchUnit(in[c] * 65535.0f, lower[c], upper[c]) * scale);
+                }
+            }
+        }
+    });
+}
+
+template <typename D>
+void dispatchFloatStretch(const cv::Mat& src, const std::vector<ContrastBounds>& bounds, cv::Mat& dst) {
+    switch (src.channels()) {
+    case 1: stretchFloatRows<D, 1>(src, bounds, dst); break;
+    case 3: stretchFloatRows<D, 3>(src, bounds, dst); break;
+    case 4: stretchFloatRows<D, 4>(src, bounds, dst); break;
+    default: CV_Error(cv::Error::StsBadArg, "Only 1, 3 and 4 channel images are supported");
+    }
+}
+
+}
+
+int histogramBins(int depth) {
+    CV_Assert(depth == CV_8U || depth == CV_16U || depth == CV_32F);
+    return depth == CV_8U ? 256 : 65536;
+}
+
+void accumulateHistogram(const cv::Mat& channel, ChannelHistogram& hist) {
+    CV_Assert(channel.channels() == 1);
+    int bins = histogramBins(channel.depth());
+    if (hist.size() != static_cast<size_t>(bins)) {
+        hist.assign(bins, 0);
+    }
+
+    switch (channel.depth()) {
+    case CV_8U: accumulateRows<uchar>(channel, hist); break;
+    case CV_16U: accumulateRows<ushort>(channel, hist); break;
+    default: accumulateRows<float>(channel, hist); break;
+    }
+}
+
+ChannelHistogram computeHistogram(const cv::Mat& channel) {
+    ChannelHistogram hist(histogramBins(channel.depth()), 0);
+    accumulateHistogram(channel, hist);
+    return hist;
+}
+
+void accumulateHistograms(const cv::Mat& image, std::vector<ChannelHistogram>& hists) {
+    accumulateSampledHistograms(image, 1, hists);
+}
+
+void accumulateSampledHistograms(const cv::Mat& image, int step, std::vector<ChannelHistogram>& hists) {
+    CV_Assert(step >= 1);
+    int cn = image.channels();
+    CV_Assert(cn == 1 || cn == 3 || cn == 4);
+    int bins = histogramBins(image.depth());
+    hists.resize(cn);
+
+    uint64_t* counts[4];
+    for (int c = 0; c < cn; ++c) {
+        if (hists[c].size() != static_cast<size_t>(bins)) {
+            hists[c].assign(bins, 0);
+        }
+        counts[c] = hists[c].data();
+    }
+
+    switch (image.depth()) {
+    case CV_8U: dispatchPacked<uchar>(image, step, counts); break;
+    case CV_16U: dispatchPacked<ushort>(image, step, counts); break;
+    default: dispatchPacked<float>(image, step, counts); break;
+    }
+}
+
+std::vector<ChannelHistogram> computeHistograms(const cv::Mat& image) {
+    std::vector<ChannelHistogram> hists;
+    accumulateHistograms(image, hists);
+    return hists;
+}
+
+int sampleStep(const cv::Size& size, double epsilon) {
+    if (epsilon <= 0) return 1;
+    // Неравенство Дворецкого–Кифера–Вольфовица: n выборок дают функцию распределения
+    // с отклонением больше epsilon с вероятностью не выше 2 exp(-2 n epsilon^2)
+    const double kFailure = 0.01;
+    double samples = std::ceil(std::log(2 / kFailure) / (2 * epsilon * epsilon));
+    double pixels = static_cast<double>(size.width) * size.height;
+    // Шаг не больше меньшей стороны: у полосы в несколько строк прореживаются не одни строки
+    int step = static_cast<int>(std::sqrt(pixels / samples));
+    return std::max(1, std::min(step, std::min(size.width, size.height)));
+}
+
+double quantileRankError(const ChannelHistogram& hist, float value, double q) {
+    uint64_t total = 0, below = 0;
+    int v = std::min(std::max(cvRound(value), 0), static_cast<int>(hist.size()) - 1);
+    for (size_t b = 0; b < hist.size(); ++b) {
+        total += hist[b];
+        if (static_cast<int>(b) < v) below += hist[b];
+    }
+    CV_Assert(total > 0);
+
+    // Значение v занимает в отсортированном массиве ранги [below, below + hist[v])
+    double lower = static_cast<double>(below) / total;
+    double upper = static_cast<double>(below + hist[v]) / total;
+    if (q < lower) return lower - q;
+    if (q > upper) return q - upper;
+    return 0;
+}
+
+ContrastBounds quantileBounds(const ChannelHistogram& hist, double q_b, double q_w) {
+    uint64_t total = 0;
+    for (uint64_t count : hist) total += count;
+    CV_Assert(total > 0);
+
+    ContrastBounds bounds;
+    bounds.lower = static_cast<float>(valueAtIndex(hist, quantileIndex(q_b, total)));
+    bounds.upper = static_cast<float>(valueAtIndex(hist, quantileIndex(q_w, total)));
+    return bounds;
+}
+
+std::vector<ContrastBounds> quantileBounds(const std::vector<ChannelHistogram>& hists, double q_b, double q_w) {
+    std::vector<ContrastBounds> bounds;
+    quantileBounds(hists, q_b, q_w, bounds);
+    return bounds;
+}
+
+void quantileBounds(const std::vector<ChannelHistogram>& hists, double q_b, double q_w,
+                    std::vector<ContrastBounds>& bounds) {
+    bounds.resize(hists.size());
+    for (size_t c = 0; c < hists.size(); ++c) {
+        bounds[c] = quantileBounds(hists[c], q_b, q_w);
+    }
+}
+
+cv::Mat contrastLut(const ContrastBounds& bounds, int depth) {
+    if (depth == CV_8U) {
+        return PointPipeline().stretch(bounds.lower, bounds.upper).lut();
+    }
+
+    int bins = histogramBins(depth);
+    cv::Mat lut(1, bins, CV_8UC1);
+    uchar* table = lut.ptr<uchar>();
+    for (int v = 0; v < bins; ++v) {
+        table[v] = stretchValue(static_cast<float>(v), bounds.lower, bounds.upper);
+    }
+    return lut;
+}
+
+cv::Mat contrastLut(const std::vector<ContrastBounds>& bounds, int depth) {
+    cv::Mat lut;
+    contrastLut(bounds, depth, lut);
+    return lut;
+}
+
+void contrastLut(const std::vector<ContrastBounds>& bounds, int depth, cv::Mat& lut, int ddepth) {
+    CV_Assert(ddepth == CV_8U || ddepth == CV_16U);
+    // Значения те же, что у одноканальных таблиц, но сразу в чередующемся порядке, без cv::merge
+    int bins = histogramBins(depth);
+    int cn = static_cast<int>(bounds.size());
+    lut.create(1, bins, CV_MAKETYPE(ddepth, cn));
+    if (ddepth == CV_8U) {
+        uchar* table = lut.ptr<uchar>();
+        for (int v = 0; v < bins; ++v) {
+            for (int c = 0; c < cn; ++c) {
+                table[v * cn + c] = stretchValue(static_cast<float>(v), bounds[c].lower, bounds[c].upper);
+            }
+        }
+    } else {
+        ushort* table = lut.ptr<ushort>();
+        for (int v = 0; v < bins; ++v) {
+            for (int c = 0; c < cn; ++c) {
+                float unit = stretchUnit(static_cast<float>(v), bounds[c].lower, bounds[c].upper);
+                table[v * cn + c] = cv::saturate_cast<ushort>(unit * 65535.0f);
+            }
+        }
+    }
+}
+
+ChannelHistogram stretchedHistogram(const ChannelHistogram& hist, const ContrastBounds& bounds) {
+    int depth = hist.size() == 256 ? CV_8U : CV_16U;
+    cv::Mat lut = contrastLut(bounds, depth);
+    const uchar* table = lut.ptr<uchar>();
+
+    ChannelHistogram result(256, 0);
+    for (size_t v = 0; v < hist.size(); ++v) {
+        result[table[v]] += hist[v];
+    }
+    return result;
+}
+
+void applyContrastLut(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst) {
+    CV_Assert(src.channels() == 1);
+    applyPointLut(src, lut, dst);
+}
+
+void autoContrastChannel(cv::Mat& channel, double q_b, double q_w) {
+    ContrastWorkspace workspace;
+    autoContrastChannel(channel, q_b, q_w, workspace);
+}
+
+void autoContrastChannel(cv::Mat& channel, double q_b, double q_w, ContrastWorkspace& workspace) {
+    workspace.histograms.resize(1);
+    ChannelHistogram& hist = workspace.histograms[0];
+    std::fill(hist.begin(), hist.end(), 0);
+    accumulateHistogram(channel, hist);
+    workspace.bounds.assign(1, quantileBounds(hist, q_b, q_w));
+    applyContrast(channel, workspace.bounds, channel, workspace.lut);
+}
+
+void applyContrast(const cv::Mat& src, const std::vector<ContrastBounds>& bounds, cv::Mat& dst) {
+    cv::Mat lut;
+    applyContrast(src, bounds, dst, lut);
+}
+
+void applyContrast(const cv::Mat& src, const std::vector<ContrastBounds>& bounds, cv::Mat& dst, cv::Mat& lut,
+                   int ddepth) {
+    CV_Assert(static_cast<int>(bounds.size()) == src.channels());
+    if (src.depth() == CV_32F) {
+        // Таблицу на float не построить: растяжение считается поэлементно.
+        // Заголовок источника сохраняется до create, чтобы dst мог совпадать с src
+        cv::Mat input = src;
+        dst.create(input.size(), CV_MAKETYPE(ddepth, input.channels()));
+        cv::Mat output = dst;
+        switch (ddepth) {
+        case CV_8U: dispatchFloatStretch<uchar>(input, bounds, output); break;
+        case CV_16U: dispatchFloatStretch<ushort>(input, bounds, output); break;
+        case CV_32F: dispatchFloatStretch<float>(input, bounds, output); break;
+        default: CV_Error(cv::Error::StsBadArg, "Only CV_8U, CV_16U and CV_32F results are supported");
+        }
+    } else if (src.channels() == 1 && ddepth == CV_8U) {
+        applyLinearStretch(src, bounds[0].lower, bounds[0].upper, dst);
+    } else {
+        contrastLut(bounds, src.depth(), lut, ddepth);
+        applyPointLut(src, lut, dst);
+    }
+}
+
+void autoContrastImage(const cv::Mat& src, cv::Mat& dst, double q_b, double q_w) {
+    ContrastWorkspace workspace;
+    autoContrastImage(src, dst, q_b, q_w, workspace);
+}
+
+void autoContrastImage(const cv::Mat& src, cv::Mat& dst, double q_b, double q_w, ContrastWorkspace& workspace,
+                       int ddepth) {
+    for (auto& hist : workspace.histograms) std::fill(hist.begin(), hist.end(), 0);
+    accumulateHistograms(src, workspace.histograms);
+    quantileBounds(workspace.histograms, q_b, q_w, workspace.bounds);
+    applyContrast(src, workspace.bounds, dst, workspace.lut, ddepth);
+}
+
+cv::Mat autoContrastImage(const cv::Mat& image, double q_b, double q_w) {
+    cv::Mat result;
+    autoContrastImage(image, result, q_b, q_w);
+    return result;
+}
+
+void autoContrastChannelSort(cv::Mat& channel, double q_b, double q_w) {
+    // Преобразование типа для работы с гистограммой
+    channel.convertTo(channel, CV_32F);
+
+    // Вычисление квантилей
+    std::vector<float> pixels;
+    pixels.assign((float*)channel.datastart, (float*)channel.dataend);
+    std::sort(pixels.begin(), pixels.end());
+
+    float lowerBound = pixels[(int)(q_b * pixels.size())];
+    float upperBound = pixels[(int)(q_w * pixels.size())];
+
+    // Применение автоконтрастирования
+    for (int i = 0; i < channel.rows; ++i) {
+        for (int j = 0; j < channel.cols; ++j) {
+            float& pixel = channel.at<float>(i, j);
+            if (pixel < lowerBound) pixel = 0;
+            else if (pixel > upperBound) pixel = 255;
+            else pixel = (pixel - lowerBound) / (upperBound - lowerBound) * 255;
+        }
+    }
+
+    channel.convertTo(channel, CV_8U); // Возвращение к исходному типу
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+// Гистограмма одного канала: 256 бинов для CV_8U, 65536 для CV_16U и CV_32F.
+// Значения float из [0, 1] квантуются на 65536 уровней (v * 65535), поэтому границы
+// контраста float-изображения тоже задаются в бинах, а не в исходных значениях.
+// Счётчики 64-битные: у cv::calcHist они float и теряют точность после 2^24 пикселей
+typedef std::vector<uint64_t> ChannelHistogram;
+
+// Границы растяжения контраста, найденные по квантилям
+struct ContrastBounds {
+    float lower;
+    float upper;
+};
+
+// Буферы автоконтрастирования, переиспользуемые между изображениями одного потока:
+// после первого изображения того же формата обработка не выделяет память в куче
+struct ContrastWorkspace {
+    std::vector<ChannelHistogram> histograms;
+    std::vector<ContrastBounds> bounds;
+    cv::Mat lut;
+};
+
+// Количество бинов гистограммы для глубины CV_8U / CV_16U / CV_32F
+int histogramBins(int depth);
+
+// Добавление пикселей одноканального изображения в гистограмму (один проход)
+void accumulateHistogram(const cv::Mat& channel, ChannelHistogram& hist);
+
+// Гистограмма одноканального изображения CV_8U / CV_16U / CV_32F
+ChannelHistogram computeHistogram(const cv::Mat& channel);
+
+// Гистограммы всех каналов изображения CV_8U / CV_16U / CV_32F с 1, 3 или 4 каналами
+// за один проход по чередующимся отсчётам, без cv::split
+void accumulateHistograms(const cv::Mat& image, std::vector<ChannelHistogram>& hists);
+std::vector<ChannelHistogram> computeHistograms(const cv::Mat& image);
+
+// Приближённые гистограммы по прореженной сетке: каждая step-я строка и каждый step-й пиксель.
+// Непрочитанные строки отображённого файла не подгружаются с диска
+void accumulateSampledHistograms(const cv::Mat& image, int step, std::vector<ChannelHistogram>& hists);
+
+// Шаг сетки, при котором квантили по выборке отличаются от точных не более чем на epsilon
+// по рангу (с вероятностью 99% по оценке Дворецкого–Кифера–Вольфовица для независимой выборки;
+// у регулярной сетки погрешность проверяется quantileRankError). epsilon <= 0 — шаг 1, без прореживания.
+// Шаг не превышает меньшую сторону изображения
+int sampleStep(const cv::Size& size, double epsilon);
+
+// Фактическая погрешность границы по рангу: расстояние от q до доли пикселей,
+// занимаемой значением value в точной гистограмме hist; 0 — граница точная
+double quantileRankError(const ChannelHistogram& hist, float value, double q);
+
+// Квантильные границы по накопленным счётчикам.
+// Совпадают с pixels[(int)(q * N)] отсортированного массива пикселей
+ContrastBounds quantileBounds(const ChannelHistogram& hist, double q_b, double q_w);
+std::vector<ContrastBounds> quantileBounds(const std::vector<ChannelHistogram>& hists, double q_b, double q_w);
+void quantileBounds(const std::vector<ChannelHistogram>& hists, double q_b, double q_w,
+                    std::vector<ContrastBounds>& bounds);
+
+// Таблица растяжения контраста (1 x bins, CV_8U) для входной глубины CV_8U / CV_16U.
+// Для CV_8U таблица строится через PointPipeline
+cv::Mat contrastLut(const ContrastBounds& bounds, int depth);
+
+// Таблица с каналом на каждую границу (1 x bins, CV_8UC(n)) для applyPointLut.
+// С ddepth == CV_16U таблица растягивает в [0, 65535] и имеет тип CV_16UC(n)
+cv::Mat contrastLut(const std::vector<ContrastBounds>& bounds, int depth);
+void contrastLut(const std::vector<ContrastBounds>& bounds, int depth, cv::Mat& lut, int ddepth = CV_8U);
+
+// Гистограмма канала после растяжения (256 бинов), пересчитанная из гистограммы входа
+// без прохода по изображению. Совпадает с результатом таблицы contrastLut; у одноканального
+// applyLinearStretch отсчёты могут отличаться на 1
+ChannelHistogram stretchedHistogram(const ChannelHistogram& hist, const ContrastBounds& bounds);
+
+// Применение таблицы к одноканальному изображению, результат CV_8U
+void applyContrastLut(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst);
+
+// Функция для автоконтрастирования одного канала: гистограмма и растяжение
+// целочисленной SIMD-арифметикой, без сортировки и без перевода в float.
+// Результат CV_8U; канал CV_32F растягивается поэлементно
+void autoContrastChannel(cv::Mat& channel, double q_b, double q_w);
+void autoContrastChannel(cv::Mat& channel, double q_b, double q_w, ContrastWorkspace& workspace);
+
+// Растяжение каждого канала по своим границам за один проход по чередующимся отсчётам.
+// Одноканальное изображение растягивается через applyLinearStretch, многоканальное —
+// через таблицу с каналом на каждую границу, построенную в lut. dst может совпадать с src
+// (для CV_8U — без выделения памяти).
+// ddepth — глубина результата: CV_8U или CV_16U (таблица на 65536 значений) для целого входа,
+// для CV_32F ещё и CV_32F со значениями в [0, 1]; float-вход растягивается без таблицы
+void applyContrast(const cv::Mat& src, const std::vector<ContrastBounds>& bounds, cv::Mat& dst);
+void applyContrast(const cv::Mat& src, const std::vector<ContrastBounds>& bounds, cv::Mat& dst, cv::Mat& lut,
+                   int ddepth = CV_8U);
+
+// Автоконтрастирование каждого канала изображения с 1, 3 или 4 каналами; q_w — верхний
+// квантиль. Гистограммы — за один проход, растяжение — за второй; dst может совпадать с src
+void autoContrastImage(const cv::Mat& src, cv::Mat& dst, double q_b, double q_w);
+void autoContrastImage(const cv::Mat& src, cv::Mat& dst, double q_b, double q_w, ContrastWorkspace& workspace,
+                       int ddepth = CV_8U);
+cv::Mat autoContrastImage(const cv::Mat& image, double q_b, double q_w);
+
+// Эталонная реализация через сортировку всех пикселей, оставлена для сравнения
+void autoContrastChannelSort(cv::Mat& channel, double q_b, double q_w);
@@ -0,0 +1,245 @@
+#include "batch.hpp"
+
+#include <opencv2/core/utils/filesystem.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "autocontrast.hpp"
+#include "bounded_queue.hpp"
+#include "run_report.hpp"
+#include "trace.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Одно изображение на пути через конвейер
+struct BatchJob {
+    std::string inputPath;
+    std::string outputPath;
+    std::vector<uchar> bytes;  // сжатые данные: на входе — исходный файл, на выходе — PNG
+    Clock::time_point started;
+};
+
+bool hasImageExtension(const std::string& path) {
+    static const char* extensions[] = {
+        ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".pgm", ".ppm", ".pnm", ".webp"
+    };
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (const char* known : extensions) {
+        if (ext == known) return true;
+    }
+    return false;
+}
+
+// Список входных файлов: содержимое каталога или строки файла-списка
+std::vector<std::string> collectInputs(const std::string& input) {
+    std::vector<std::string> paths;
+    if (cv::utils::fs::isDirectory(input)) {
+        std::vector<cv::String> found;
+        cv::glob(cv::utils::fs::join(input, "*"), found, false);
+        for (const auto& path : found) {
+            if (hasImageExtension(path)) paths.push_back(path);
+        }
+        return paths;
+    }
+
+    std::ifstream list(input);
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) paths.push_back(line);
+    }
+    return paths;
+}
+
+// Имя результата: имя входного файла вместе с расширением + .png в выходном каталоге,
+// чтобы a.jpg и a.png из одного каталога не писали в один файл
+std::string outputPathFor(const std::string& input, const std::string& outputDir) {
+    size_t slash = input.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? input : input.substr(slash + 1);
+    return cv::utils::fs::join(outputDir, name + ".png");
+}
+
+// Размер известен заранее, поэтому буфер выделяется один раз, без роста по мере чтения
+bool readFile(const std::string& path, std::vector<uchar>& bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamoff size = file.tellg();
+    if (size <= 0) return false;
+    bytes.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), size));
+}
+
+bool writeFile(const std::string& path, const std::vector<uchar>& bytes) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(file);
+}
+
+// Процентиль по ближайшему рангу для отсортированного массива
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+}
+
+int runBatch(const BatchOptions& options) {
+    std::vector<std::string> inputs = collectInputs(options.input);
+    if (inputs.empty()) {
+        std::cout << "No input images found in " << options.input << std::endl;
+        return kExitInput;
+    }
+    if (!cv::utils::fs::exists(options.outputDir) && !cv::utils::fs::createDirectories(options.outputDir)) {
+        std::cout << "Could not create output directory " << options.outputDir << std::endl;
+        return kExitOutput;
+    }
+
+    int workers = options.threads > 0 ? options.threads
+                                      : std::max(1u, std::thread::hardware_concurrency());
+
+    // Ёмкость очередей ограничивает число изображений в памяти одновременно
+    BoundedQueue<BatchJob> decodeQueue(2 * workers);
+    BoundedQueue<BatchJob> writeQueue(2 * workers);
+
+    std::atomic<int> failed(0);
+    std::mutex latencyMutex;
+    std::vector<double> latencies;
+    latencies.reserve(inputs.size());
+
+    Clock::time_point batchStart = Clock::now();
+
+    // Чтение файлов с диска — отдельный поток, чтобы ввод-вывод шёл параллельно с вычислениями
+    std::thread reader([&] {
+        // Одноимённые файлы из разных каталогов списка всё равно дают одно имя результата:
+        // второй такой вход не обрабатывается и считается ошибкой, а не перезаписывает первый
+        std::map<std::string, std::string> claimed;
+        for (const auto& path : inputs) {
+            BatchJob job;
+            job.inputPath = path;
+            job.outputPath = outputPathFor(path, options.outputDir);
+            auto claim = claimed.emplace(job.outputPath, path);
+            if (!claim.second) {
+                std::cout << "Skipping " << path << ": " << claim.first->second << " already writes "
+                          << job.outputPath << std::endl;
+                ++failed;
+                continue;
+            }
+            job.started = Clock::now();
+            bool read;
+            {
+                TraceScope scope("read", path);
+                read = readFile(path, job.bytes);
+            }
+            if (!read) {
+                std::cout << "Could not read " << path << std::endl;
+                ++failed;
+                continue;
+            }
+            decodeQueue.push(std::move(job));
+        }
+        decodeQueue.close();
+    });
+
+    // Декодирование, автоконтраст и кодирование — на пуле рабочих потоков
+    std::vector<std::thread> pool;
+    for (int w = 0; w < workers; ++w) {
+        pool.emplace_back([&] {
+            // Изображение и буферы автоконтраста живут всё время работы потока, гистограммы
+            // и таблица переиспользуются. Буфер image освобождается перед декодированием:
+            // при нераспознанной сигнатуре imdecode не трогает dst и вернул бы прошлый кадр.
+            // Освобождённый буфер остаётся в пуле и достаётся следующему изображению того же размера
+            BatchJob job;
+            cv::Mat image;
+            ContrastWorkspace workspace;
+            while (decodeQueue.pop(job)) {
+                {
+                    TraceScope scope("decode", job.inputPath);
+                    image.release();
+                    cv::imdecode(job.bytes, cv::IMREAD_COLOR, &image);
+                }
+                if (image.empty()) {
+                    std::cout << "Could not decode " << job.inputPath << std::endl;
+                    ++failed;
+                    continue;
+                }
+                {
+                    // Декодированный буфер больше нигде не нужен, поэтому растяжение идёт на месте
+                    TraceScope scope("autocontrast", job.inputPath);
+                    if (options.approx > 0) {
+                        for (auto& hist : workspace.histograms) std::fill(hist.begin(), hist.end(), 0);
+                        accumulateSampledHistograms(image, sampleStep(image.size(), options.approx),
+                                                    workspace.histograms);
+                        quantileBounds(workspace.histograms, options.q_b, options.q_w, workspace.bounds);
+                        applyContrast(image, workspace.bounds, image, workspace.lut);
+                    } else {
+                        autoContrastImage(image, image, options.q_b, options.q_w, workspace);
+                    }
+                }
+                bool encoded;
+                {
+                    TraceScope scope("encode", job.inputPath);
+                    encoded = cv::imencode(".png", image, job.bytes);
+                }
+                if (!encoded) {
+                    std::cout << "Could not encode " << job.inputPath << std::endl;
+                    ++failed;
+                    continue;
+                }
+                writeQueue.push(std::move(job));
+            }
+        });
+    }
+
+    // Запись результатов на диск
+    std::thread writer([&] {
+        BatchJob job;
+        while (writeQueue.pop(job)) {
+            bool written;
+            {
+                TraceScope scope("write", job.outputPath);
+                written = writeFile(job.outputPath, job.bytes);
+            }
+            if (!written) {
+                std::cout << "Could not write " << job.outputPath << std::endl;
+                ++failed;
+                continue;
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - job.started).count();
+            std::lock_guard<std::mutex> lock(latencyMutex);
+            latencies.push_back(ms);
+        }
+    });
+
+    reader.join();
+    for (auto& thread : pool) thread.join();
+    writeQueue.close();
+    writer.join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "Processed " << latencies.size() << " of " << inputs.size() << " images"
+              << " (" << failed.load() << " failed) in " << seconds << " s on " << workers << " threads\n"
+              << "Throughput: " << latencies.size() / seconds << " images/s\n"
+              << "Latency p50: " << percentile(latencies, 0.50) << " ms, p99: "
+              << percentile(latencies, 0.99) << " ms" << std::endl;
+
+    return failed.load() == 0 ? kExitOk : kExitPartial;
+}
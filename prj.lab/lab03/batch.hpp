@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+// Параметры пакетного режима
+struct BatchOptions {
+    std::string input;      // каталог с изображениями или текстовый файл со списком путей
+    std::string outputDir;  // каталог для результатов <имя входа>.png (создаётся при необходимости)
+    double q_b = 0.1;       // нижний квантиль
+    double q_w = 0.9;       // верхний квантиль (уже 1 - q_w из командной строки)
+    int threads = 0;        // число рабочих потоков, 0 — по числу ядер
+    double approx = 0;      // погрешность квантилей по рангу для прореженных гистограмм, 0 — точные
+};
+
+// Пакетная обработка без окон: чтение файлов, декодирование, автоконтраст и кодирование
+// идут в разных потоках через очереди ограниченной ёмкости.
+// По окончании печатает число изображений в секунду и задержки p50/p99.
+// Возвращает код завершения процесса (ExitCode)
+int runBatch(const BatchOptions& options);
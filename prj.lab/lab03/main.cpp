@@ -1,76 +1,58 @@
-#include <opencv2/opencv.hpp>
-#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
 #include <algorithm>
+#include <iostream>
+#include <vector>
 
-// Функция для автоконтрастирования одного канала
-void autoContrastChannel(cv::Mat& channel, double q_b, double q_w) {
-    // Преобразование типа для работы с гистограммой
-    channel.convertTo(channel, CV_32F);
-
-    // Вычисление квантилей
-    std::vector<float> pixels;
-    pixels.assign((float*)channel.datastart, (float*)channel.dataend);
-    std::sort(pixels.begin(), pixels.end());
-
-    float lowerBound = pixels[(int)(q_b * pixels.size())];
-    float upperBound = pixels[(int)(q_w * pixels.size())];
-
-    // Применение автоконтрастирования
-    for (int i = 0; i < channel.rows; ++i) {
-        for (int j = 0; j < channel.cols; ++j) {
-            float& pixel = channel.at<float>(i, j);
-            if (pixel < lowerBound) pixel = 0;
-            else if (pixel > upperBound) pixel = 255;
-            else pixel = (pixel - lowerBound) / (upperBound - lowerBound) * 255;
-        }
-    }
-
-    channel.convertTo(channel, CV_8U); // Возвращение к исходному типу
-}
-
-// Функция для отрисовки гистограммы яркости для одного канала
-cv::Mat draw_histogram(const cv::Mat& src) {
-    std::vector<cv::Mat> bgr_planes;
-    cv::split(src, bgr_planes);
-
-    int histSize = 256;
-    float range[] = { 0, 256 };
-    const float* histRange = { range };
-    bool uniform = true, accumulate = false;
-    std::vector<cv::Mat> histArray;
-
-    // Отрисовка гистограммы для каждого канала
-    for (int i = 0; i < src.channels(); ++i) {
-        cv::Mat hist;
-        cv::calcHist(&bgr_planes[i], 1, 0, cv::Mat(), hist, 1, &histSize, &histRange, uniform, accumulate);
-
-        int hist_w = 512; int hist_h = 400;
-        int bin_w = cvRound((double) hist_w / histSize);
+#include "autocontrast.hpp"
+#include "batch.hpp"
+#include "buffer_pool.hpp"
+#include "display.hpp"
+#include "mapped_image.hpp"
+#include "run_report.hpp"
+#include "streaming.hpp"
+#include "trace.hpp"
+#include "video.hpp"
 
-        cv::Mat histImage(hist_h, hist_w, CV_8UC3, cv::Scalar(0,0,0));
+// Функция для отрисовки гистограммы яркости одного канала по готовым счётчикам;
+// histImage того же размера переиспользуется
+void draw_histogram(const ChannelHistogram& hist, cv::Mat& histImage) {
+    int histSize = static_cast<int>(hist.size());
+    int hist_w = 512; int hist_h = 400;
+    double bin_w = static_cast<double>(hist_w) / histSize;
 
-        // Нормализация результатов к [0, histImage.rows]
-        cv::normalize(hist, hist, 0, histImage.rows, cv::NORM_MINMAX, -1, cv::Mat());
+    histImage.create(hist_h, hist_w, CV_8UC3);
+    histImage.setTo(cv::Scalar(0,0,0));
 
-        // Отрисовка для каждого бина
-        for (int j = 1; j < histSize; j++) {
-            cv::line(histImage, cv::Point(bin_w*(j-1), hist_h - cvRound(hist.at<float>(j-1))),
-                     cv::Point(bin_w*(j), hist_h - cvRound(hist.at<float>(j))),
-                     cv::Scalar(255, 0, 0), 2, 8, 0);
-        }
+    // Нормализация результатов к [0, histImage.rows]
+    uint64_t min_count = *std::min_element(hist.begin(), hist.end());
+    uint64_t max_count = *std::max_element(hist.begin(), hist.end());
+    double scale = max_count > min_count ? static_cast<double>(hist_h) / (max_count - min_count) : 0;
+    auto height = [&](int bin) { return hist_h - cvRound((hist[bin] - min_count) * scale); };
 
-        histArray.push_back(histImage);
+    // Отрисовка для каждого бина
+    for (int j = 1; j < histSize; j++) {
+        cv::line(histImage, cv::Point(cvRound(bin_w*(j-1)), height(j-1)),
+                 cv::Point(cvRound(bin_w*j), height(j)),
+                 cv::Scalar(255, 0, 0), 2, 8, 0);
     }
-
-    // Возвращаем только первую гистограмму для примера
-    // В вашем случае, вы можете выбрать, как отображать все гистограммы
-    return histArray[0];
 }
 
 int main(int argc, char** argv) {
 
     double q_b = 0.1, q_w = 0.1; // значения по умолчанию
     std::string inputFilename = "../source/x.jpeg"; // значение по умолчанию
+    std::string outputPath; // -o: каталог для пакетного режима или файл результата
+    BatchOptions batch; // пакетный режим: -batch <каталог или список> -o <каталог> [-j потоки]
+    StreamOptions stream; // потоковый режим для PGM/PPM: -stream -o <файл> [-strip строки]
+    bool streaming = false;
+    VideoOptions video; // видео или камера: -video <файл или номер камеры> [-o <файл>] [-smooth a]
+    std::string tracePath; // -trace <файл>: этапы обработки в формате Chrome trace JSON
+    size_t pool_mb = 256; // -pool <МБ>: бюджет пула буферов cv::Mat, 0 — без пула
+    bool show = false; // -show: окна с результатом (только в сборке с MISIS_WITH_DISPLAY)
+    double approx = 0; // -approx <eps>: границы по прореженной выборке с погрешностью eps по рангу
+    int bits = 8; // -depth <8|16|32>: глубина результата одиночного изображения, 32 — только для float
+    RunReport report("lab_3"); // -report <файл или ->: итог запуска в JSON
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -78,44 +60,222 @@ int main(int argc, char** argv) {
             q_b = std::stod(argv[++i]);
         } else if (arg == "-q_w" && i + 1 < argc) {
             q_w = std::stod(argv[++i]);
+        } else if (arg == "-batch" && i + 1 < argc) {
+            batch.input = argv[++i];
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "-j" && i + 1 < argc) {
+            batch.threads = std::stoi(argv[++i]);
+        } else if (arg == "-stream") {
+            streaming = true;
+        } else if (arg == "-strip" && i + 1 < argc) {
+            stream.stripRows = std::stoi(argv[++i]);
+        } else if (arg == "-video" && i + 1 < argc) {
+            video.input = argv[++i];
+        } else if (arg == "-smooth" && i + 1 < argc) {
+            video.smoothing = std::stod(argv[++i]);
+        } else if (arg == "-ring" && i + 1 < argc) {
+            video.ringSize = std::stoi(argv[++i]);
+        } else if (arg == "-frames" && i + 1 < argc) {
+            video.maxFrames = std::stoi(argv[++i]);
+        } else if (arg == "-fourcc" && i + 1 < argc) {
+            video.fourcc = argv[++i];
+        } else if (arg == "-trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "-pool" && i + 1 < argc) {
+            pool_mb = std::stoul(argv[++i]);
+        } else if (arg == "-show") {
+            show = true;
+        } else if (arg == "-approx" && i + 1 < argc) {
+            approx = std::stod(argv[++i]);
+        } else if (arg == "-depth" && i + 1 < argc) {
+            bits = std::stoi(argv[++i]);
+        } else if (arg == "-report" && i + 1 < argc) {
+            report.setPath(argv[++i]);
         } else {
             inputFilename = arg;
         }
     }
-    std::cout << q_b << " " << q_w << "\n";
+    if (bits != 8 && bits != 16 && bits != 32) {
+        std::cout << "-depth must be 8, 16 or 32" << std::endl;
+        return report.finish(kExitUsage);
+    }
+    // Доли отсекаемых хвостов, как заданы в командной строке, — в отчёт, а не в std::cout
+    report.set("q_b", q_b);
+    report.set("q_w", q_w);
+    int ddepth = bits == 8 ? CV_8U : bits == 16 ? CV_16U : CV_32F;
+
+    if (!tracePath.empty()) {
+        traceStart(tracePath);
+    }
+
+    // Пул ставится после трассировки, поэтому в ней видны только выделения мимо пула
+    BufferPool* pool = pool_mb > 0 ? installBufferPool(pool_mb << 20) : nullptr;
+
+    if (!batch.input.empty()) {
+        batch.q_b = q_b;
+        batch.q_w = 1 - q_w;
+        batch.approx = approx;
+        batch.outputDir = outputPath.empty() ? "auto_contrasted" : outputPath;
+        report.set("mode", "batch");
+        report.set("input", batch.input);
+        report.set("output", batch.outputDir);
+        int status = runBatch(batch);
+        printBufferPoolStats(pool);
+        traceFinish();
+        return report.finish(status);
+    }
+
+    if (!video.input.empty()) {
+        video.output = outputPath;
+        video.q_b = q_b;
+        video.q_w = 1 - q_w;
+        report.set("mode", "video");
+        report.set("input", video.input);
+        report.set("output", video.output);
+        int status = runVideo(video);
+        printBufferPoolStats(pool);
+        traceFinish();
+        return report.finish(status);
+    }
+
+    if (streaming) {
+        stream.input = inputFilename;
+        stream.output = outputPath.empty() ? "auto_contrasted_image.pnm" : outputPath;
+        stream.q_b = q_b;
+        stream.q_w = 1 - q_w;
+        report.set("mode", "stream");
+        report.set("input", stream.input);
+        report.set("output", stream.output);
+        int status = runStreaming(stream);
+        printBufferPoolStats(pool);
+        traceFinish();
+        return report.finish(status);
+    }
+
+    // PGM/PPM/raw отображаются в память. Если результат пишется в тот же файл,
+    // он открывается для записи и растягивается на месте
+    std::string outputFilename = outputPath.empty() ? "auto_contrasted_image.png" : outputPath;
+    bool sameFile = outputFilename == inputFilename;
+    bool inPlace = sameFile && isMappableImage(inputFilename);
+    report.set("mode", "image");
+    report.set("input", inputFilename);
+    report.set("output", outputFilename);
 
     // Чтение изображения
-    cv::Mat image = cv::imread(inputFilename);
+    MappedImage inputMapping;
+    cv::Mat image;
+    {
+        TraceScope scope("load", inputFilename);
+        if (inPlace && inputMapping.open(inputFilename, true) && inputMapping.mat().depth() == ddepth) {
+            image = inputMapping.mat();
+        } else {
+            inPlace = false;
+            // Для результата глубже 8 бит исходная глубина сохраняется и при декодировании
+            int flags = ddepth == CV_8U ? cv::IMREAD_COLOR : cv::IMREAD_COLOR | cv::IMREAD_ANYDEPTH;
+            image = readImage(inputFilename, inputMapping, flags);
+            // Файл нельзя растянуть на месте (16-битный PNM, другая глубина результата), а результат
+            // пересоздаст его: вход копируется и отображение снимается до записи
+            if (sameFile && inputMapping.isOpen()) {
+                image = image.clone();
+                inputMapping.close();
+            }
+        }
+    }
     if (image.empty()) {
         std::cout << "Could not open or find the image" << std::endl;
-        return -1;
+        traceFinish();
+        return report.finish(kExitInput);
+    }
+    if (ddepth == CV_32F && image.depth() != CV_32F) {
+        std::cout << "-depth 32 requires a floating-point image" << std::endl;
+        traceFinish();
+        return report.finish(kExitUsage);
     }
-
-    // Если ваше изображение цветное, измените количество каналов на 3
-    const int Number_of_channels = 3; // Для цветного изображения
-    std::vector<cv::Mat> channels;
-    cv::split(image, channels);
 
     // Параметры квантилей для автоконтрастирования
     q_w = 1-q_w; // Верхний квантиль
 
-    std::vector<cv::Mat> histograms;
+    // Гистограммы всех каналов строятся за один проход, растяжение выполняется
+    // на месте во втором проходе, без разделения на плоскости и слияния.
+    // С -approx гистограммы строятся по прореженной сетке, а границы применяются к полному изображению
+    std::vector<ChannelHistogram> histograms;
+    std::vector<ContrastBounds> bounds;
+    int step = sampleStep(image.size(), approx);
+    {
+        TraceScope scope("histogram");
+        accumulateSampledHistograms(image, step, histograms);
+        bounds = quantileBounds(histograms, q_b, q_w);
+    }
+
+    // Фактическая погрешность приближённых границ считается по точной гистограмме после записи
+    // результата, чтобы не задерживать его; при растяжении файла на месте — до растяжения
+    std::vector<ChannelHistogram> exact;
+    if (step > 1 && inPlace) {
+        TraceScope scope("verify");
+        exact = computeHistograms(image);
+    }
 
-    // Применение автоконтрастирования и отрисовка гистограмм для каждого канала
-    for (int i = 0; i < Number_of_channels; ++i) {
-        autoContrastChannel(channels[i], q_b, q_w);
-        histograms.push_back(draw_histogram(channels[i]));
+    // Результат отображённого формата пишется прямо в созданный файл
+    MappedImage outputMapping;
+    // Без отображения результат пишется поверх декодированного входа, кроме режима -approx:
+    // вход ещё нужен для проверки
+    cv::Mat result = step > 1 && !inPlace ? cv::Mat() : image;
+    if (!inPlace && isMappableImage(outputFilename) &&
+        outputMapping.create(outputFilename, image.rows, image.cols, CV_MAKETYPE(ddepth, image.channels()))) {
+        result = outputMapping.mat();
+    }
+    uchar* mappedOutput = inPlace ? image.data : outputMapping.isOpen() ? result.data : nullptr;
+    {
+        TraceScope scope("autocontrast");
+        cv::Mat lut;
+        applyContrast(image, bounds, result, lut, ddepth);
     }
 
-    // Слияние обработанных каналов обратно в одно изображение и показ гистограмм
-    cv::Mat result;
-    cv::merge(channels, result);
+    report.set("width", image.cols);
+    report.set("depth", bits);
+    report.set("height", image.rows);
+    report.set("lower", bounds[0].lower);
+    report.set("upper", bounds[0].upper);
+
+    // Кодирование нужно, только если результат не оказался в отображённом файле
+    bool written = true;
+    if (result.data != mappedOutput) {
+        TraceScope scope("encode", outputFilename);
+        written = writeImage(outputFilename, result);
+    }
+    if (!written) {
+        std::cout << "Could not write " << outputFilename << std::endl;
+    }
 
-    cv::imshow("Histogram", histograms[0]);
-    cv::imshow("Auto-Contrasted Image", result);
-    cv::waitKey(0);
+    if (step > 1) {
+        if (exact.empty()) {
+            TraceScope scope("verify");
+            exact = computeHistograms(image);
+        }
+        double error = 0;
+        for (size_t c = 0; c < exact.size(); ++c) {
+            error = std::max(error, quantileRankError(exact[c], bounds[c].lower, q_b));
+            error = std::max(error, quantileRankError(exact[c], bounds[c].upper, q_w));
+        }
+        std::cout << "Sample step " << step << ", quantile error " << error << " (bound " << approx << ")"
+                  << std::endl;
+        report.set("approx", approx);
+        report.set("sample_step", step);
+        report.set("quantile_error", error);
+    }
 
-    cv::imwrite("auto_contrasted_image.png", result);
+    // Гистограмма нужна только для показа; без -show инструмент не трогает HighGUI.
+    // Гистограмма первого канала результата пересчитывается из исходной, без прохода по изображению
+    if (show) {
+        cv::Mat histImage;
+        {
+            TraceScope scope("draw histogram");
+            draw_histogram(stretchedHistogram(histograms[0], bounds[0]), histImage);
+        }
+        showImages({{"Histogram", histImage}, {"Auto-Contrasted Image", result}});
+    }
+    traceFinish();
 
-    return 0;
+    return report.finish(written ? kExitOk : kExitOutput);
 }
@@ -0,0 +1,88 @@
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "run_report.hpp"
+
+// Синтетический ролик для проверки режима -video без внешних файлов и камеры.
+// Кадры низкоконтрастные и с разными диапазонами каналов, яркость медленно плавает,
+// а на середине ролика сцена резко темнеет — сглаживание границ должно это догнать
+// за несколько кадров без мерцания. Шум с фиксированным seed, поэтому ролик воспроизводим
+
+namespace {
+
+void drawFrame(int index, int frames, cv::Mat& frame, cv::RNG& rng) {
+    const int width = frame.cols;
+    const int height = frame.rows;
+
+    // Медленное колебание яркости и скачок сцены на середине ролика
+    double drift = 15.0 * std::sin(2 * CV_PI * index / 50.0);
+    double scene = index < frames / 2 ? 0 : -40;
+
+    for (int y = 0; y < height; ++y) {
+        cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < width; ++x) {
+            double base = 90 + 60.0 * x / width + drift + scene;
+            row[x] = cv::Vec3b(cv::saturate_cast<uchar>(base - 10),
+                               cv::saturate_cast<uchar>(base),
+                               cv::saturate_cast<uchar>(base * 0.8 + 30));
+        }
+    }
+
+    // Движущийся светлый круг и неподвижный тёмный прямоугольник дают хвосты гистограммы
+    cv::Point center(static_cast<int>((index * 4) % width), height / 2);
+    cv::circle(frame, center, height / 6, cv::Scalar(175 + scene / 2, 185 + scene / 2, 170 + scene / 2), cv::FILLED);
+    cv::rectangle(frame, cv::Rect(width / 8, height / 8, width / 6, height / 5),
+                  cv::Scalar(60 + scene / 2, 65 + scene / 2, 70 + scene / 2), cv::FILLED);
+
+    cv::Mat noise(frame.size(), CV_8UC3);
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 6);
+    frame += noise;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string output = "test_clip.avi"; // результат; MJPG в AVI пишется встроенным кодеком OpenCV
+    int frames = 120; // -frames <N>: длина ролика
+    int width = 320, height = 240; // -size <W> <H>: размер кадра
+    double fps = 25;
+    std::string fourcc = "MJPG"; // -fourcc <XXXX>: кодек
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-frames" && i + 1 < argc) {
+            frames = std::stoi(argv[++i]);
+        } else if (arg == "-size" && i + 2 < argc) {
+            width = std::stoi(argv[++i]);
+            height = std::stoi(argv[++i]);
+        } else if (arg == "-fourcc" && i + 1 < argc) {
+            fourcc = argv[++i];
+        } else {
+            output = arg;
+        }
+    }
+    if (frames <= 0 || width <= 0 || height <= 0 || fourcc.size() != 4) {
+        std::cout << "Usage: " << argv[0] << " [output.avi] [-frames N] [-size W H] [-fourcc XXXX]" << std::endl;
+        return kExitUsage;
+    }
+
+    cv::VideoWriter writer;
+    int code = cv::VideoWriter::fourcc(fourcc[0], fourcc[1], fourcc[2], fourcc[3]);
+    if (!writer.open(output, code, fps, cv::Size(width, height), true)) {
+        std::cout << "Could not create " << output << std::endl;
+        return kExitOutput;
+    }
+
+    cv::Mat frame(height, width, CV_8UC3);
+    cv::RNG rng(12345);
+    for (int i = 0; i < frames; ++i) {
+        drawFrame(i, frames, frame, rng);
+        writer.write(frame);
+    }
+    std::cout << "Wrote " << frames << " frames to " << output << std::endl;
+    return kExitOk;
+}
@@ -0,0 +1,79 @@
+#include "streaming.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "autocontrast.hpp"
+#include "pnm.hpp"
+#include "pointops.hpp"
+#include "run_report.hpp"
+#include "trace.hpp"
+
+int runStreaming(const StreamOptions& options) {
+    // Выходной файл создаётся до второго прохода по входу, поэтому запись поверх входа
+    // уничтожила бы его; на месте растягивает только обычный режим через отображение файла
+    if (options.output == options.input) {
+        std::cout << "Streaming mode cannot write over its input " << options.input
+                  << " (use the non-streaming mode for in-place processing)" << std::endl;
+        return kExitUsage;
+    }
+
+    PnmStripReader reader;
+    if (!reader.open(options.input)) {
+        std::cout << "Could not open " << options.input
+                  << " (streaming mode expects a binary PGM/PPM file)" << std::endl;
+        return kExitInput;
+    }
+    const PnmHeader& header = reader.header();
+    int stripRows = std::max(1, options.stripRows);
+
+    // Полоса переиспользуется между итерациями; каналы обрабатываются в чередующемся виде
+    cv::Mat strip;
+
+    // Первый проход: гистограммы всех каналов по полосам
+    std::vector<ChannelHistogram> histograms;
+    {
+        TraceScope scope("histogram pass", options.input);
+        while (reader.read(strip, stripRows) > 0) {
+            accumulateHistograms(strip, histograms);
+        }
+    }
+    std::vector<ContrastBounds> bounds = quantileBounds(histograms, options.q_b, options.q_w);
+
+    // Таблица многоканального изображения строится один раз, а не для каждой полосы
+    cv::Mat lut;
+    if (header.channels > 1) {
+        lut = contrastLut(bounds, header.depth());
+    }
+
+    // Второй проход: применение таблиц и запись полос
+    PnmStripWriter writer;
+    if (!writer.open(options.output, header.width, header.height, header.channels, 255)) {
+        std::cout << "Could not create " << options.output << std::endl;
+        return kExitOutput;
+    }
+
+    reader.rewind();
+    TraceScope scope("apply pass", options.output);
+    cv::Mat result;
+    int written = 0;
+    while (int rows = reader.read(strip, stripRows)) {
+        if (lut.empty()) {
+            applyContrast(strip, bounds, result);
+        } else {
+            applyPointLut(strip, lut, result);
+        }
+        if (!writer.write(result)) {
+            std::cout << "Could not write " << options.output << std::endl;
+            return kExitOutput;
+        }
+        written += rows;
+    }
+
+    if (written != header.height) {
+        std::cout << "Unexpected end of file in " << options.input << std::endl;
+        return kExitInput;
+    }
+    return kExitOk;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// Параметры потоковой обработки изображений, не помещающихся в память
+struct StreamOptions {
+    std::string input;     // бинарный PGM/PPM, 8 или 16 бит
+    std::string output;    // результат в том же формате, 8 бит; не может совпадать с input
+    double q_b = 0.1;      // нижний квантиль
+    double q_w = 0.9;      // верхний квантиль (уже 1 - q_w из командной строки)
+    int stripRows = 256;   // высота полосы; память ограничена размером полосы, а не изображения
+};
+
+// Двухпроходное автоконтрастирование полосами: первый проход строит гистограммы каналов,
+// второй применяет таблицы и дописывает полосы в выходной файл.
+// Возвращает код завершения процесса (ExitCode)
+int runStreaming(const StreamOptions& options);
@@ -0,0 +1,209 @@
+#include "video.hpp"
+
+#include <opencv2/videoio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "autocontrast.hpp"
+#include "bounded_queue.hpp"
+#include "run_report.hpp"
+#include "trace.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Ячейка кольца: буферы выделяются на первом кадре и дальше переиспользуются
+struct FrameSlot {
+    cv::Mat frame;
+    std::vector<ChannelHistogram> histograms;
+    std::vector<ContrastBounds> bounds;
+    cv::Mat lut;
+    int index = 0;
+};
+
+// Гистограммы каналов, сглаженные по времени: h = (1 - a) * h + a * (счётчики кадра / N).
+// Обновление стоит O(бинов) на кадр; квантили ищутся по сглаженным долям
+class SmoothedHistogram {
+public:
+    explicit SmoothedHistogram(double alpha) : alpha_(std::min(std::max(alpha, 0.0), 1.0)) {}
+
+    void update(const std::vector<ChannelHistogram>& frame) {
+        bool reset = smoothed_.size() != frame.size();
+        smoothed_.resize(frame.size());
+        for (size_t c = 0; c < frame.size(); ++c) {
+            const ChannelHistogram& hist = frame[c];
+            std::vector<double>& h = smoothed_[c];
+            uint64_t total = 0;
+            for (uint64_t count : hist) total += count;
+            if (total == 0) continue;
+
+            // Первый кадр (или смена формата) задаёт начальное состояние целиком
+            double alpha = (reset || h.size() != hist.size()) ? 1.0 : alpha_;
+            h.resize(hist.size(), 0.0);
+            for (size_t v = 0; v < hist.size(); ++v) {
+                h[v] = (1 - alpha) * h[v] + alpha * static_cast<double>(hist[v]) / static_cast<double>(total);
+            }
+        }
+    }
+
+    void bounds(double q_b, double q_w, std::vector<ContrastBounds>& result) const {
+        result.resize(smoothed_.size());
+        for (size_t c = 0; c < smoothed_.size(); ++c) {
+            result[c].lower = static_cast<float>(valueAt(smoothed_[c], q_b));
+            result[c].upper = static_cast<float>(valueAt(smoothed_[c], q_w));
+        }
+    }
+
+private:
+    // Наименьшее значение, у которого накопленная доля превышает q, как valueAtIndex для счётчиков
+    static int valueAt(const std::vector<double>& h, double q) {
+        double cumulative = 0;
+        for (size_t v = 0; v < h.size(); ++v) {
+            cumulative += h[v];
+            if (cumulative > q) return static_cast<int>(v);
+        }
+        return static_cast<int>(h.size()) - 1;
+    }
+
+    double alpha_;
+    std::vector<std::vector<double>> smoothed_;
+};
+
+bool isCameraIndex(const std::string& input) {
+    return !input.empty() && std::all_of(input.begin(), input.end(),
+                                         [](unsigned char c) { return std::isdigit(c) != 0; });
+}
+
+std::string frameDetail(int index) {
+    return traceEnabled() ? "frame " + std::to_string(index) : std::string();
+}
+
+}
+
+int runVideo(const VideoOptions& options) {
+    cv::VideoCapture capture;
+    if (isCameraIndex(options.input)) {
+        capture.open(std::stoi(options.input));
+    } else {
+        capture.open(options.input);
+    }
+    if (!capture.isOpened()) {
+        std::cout << "Could not open video " << options.input << std::endl;
+        return kExitInput;
+    }
+    if (options.fourcc.size() != 4) {
+        std::cout << "FourCC must have 4 characters: " << options.fourcc << std::endl;
+        return kExitUsage;
+    }
+
+    double fps = capture.get(cv::CAP_PROP_FPS);
+    if (fps <= 0) fps = 30;
+
+    // Число ячеек кольца ограничивает и память, и число кадров в обработке
+    int ring = std::max(2, options.ringSize);
+    std::vector<FrameSlot> slots(ring);
+    BoundedQueue<int> freeSlots(ring);
+    BoundedQueue<int> analyzeQueue(ring);
+    BoundedQueue<int> remapQueue(ring);
+    BoundedQueue<int> encodeQueue(ring);
+    for (int i = 0; i < ring; ++i) freeSlots.push(i);
+
+    std::atomic<bool> failed(false);
+    int processed = 0;
+    Clock::time_point start = Clock::now();
+
+    // Декодирование в свободную ячейку: VideoCapture::read переиспользует буфер того же размера
+    std::thread decoder([&] {
+        int slot;
+        for (int index = 0; options.maxFrames <= 0 || index < options.maxFrames; ++index) {
+            if (!freeSlots.pop(slot)) break;
+            FrameSlot& s = slots[slot];
+            bool read;
+            {
+                TraceScope scope("decode", frameDetail(index));
+                read = capture.read(s.frame);
+            }
+            if (!read || s.frame.empty()) break;
+            s.index = index;
+            analyzeQueue.push(slot);
+        }
+        analyzeQueue.close();
+    });
+
+    // Анализ идёт строго по порядку кадров: сглаживание зависит от предыдущего состояния
+    SmoothedHistogram smoothed(options.smoothing);
+    std::thread analyzer([&] {
+        int slot;
+        while (analyzeQueue.pop(slot)) {
+            FrameSlot& s = slots[slot];
+            TraceScope scope("analyze", frameDetail(s.index));
+            for (auto& hist : s.histograms) std::fill(hist.begin(), hist.end(), 0);
+            accumulateHistograms(s.frame, s.histograms);
+            smoothed.update(s.histograms);
+            smoothed.bounds(options.q_b, options.q_w, s.bounds);
+            remapQueue.push(slot);
+        }
+        remapQueue.close();
+    });
+
+    // Растяжение на месте, внутри — parallel_for_ по строкам
+    std::thread remapper([&] {
+        int slot;
+        while (remapQueue.pop(slot)) {
+            FrameSlot& s = slots[slot];
+            {
+                TraceScope scope("remap", frameDetail(s.index));
+                applyContrast(s.frame, s.bounds, s.frame, s.lut);
+            }
+            encodeQueue.push(slot);
+        }
+        encodeQueue.close();
+    });
+
+    // Кодирование; ячейка возвращается в кольцо после записи
+    std::thread encoder([&] {
+        cv::VideoWriter writer;
+        int slot;
+        while (encodeQueue.pop(slot)) {
+            FrameSlot& s = slots[slot];
+            if (!options.output.empty() && !failed) {
+                if (!writer.isOpened()) {
+                    const std::string& f = options.fourcc;
+                    int fourcc = cv::VideoWriter::fourcc(f[0], f[1], f[2], f[3]);
+                    if (!writer.open(options.output, fourcc, fps, s.frame.size(), s.frame.channels() > 1)) {
+                        std::cout << "Could not create " << options.output << std::endl;
+                        failed = true;
+                        freeSlots.close(); // декодер останавливается, оставшиеся кадры дочитываются
+                    }
+                }
+                if (writer.isOpened()) {
+                    TraceScope scope("encode", frameDetail(s.index));
+                    writer.write(s.frame);
+                }
+            }
+            ++processed;
+            freeSlots.push(slot);
+        }
+    });
+
+    decoder.join();
+    analyzer.join();
+    remapper.join();
+    encoder.join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (processed == 0) {
+        std::cout << "No frames read from " << options.input << std::endl;
+        return kExitInput;
+    }
+    std::cout << "Processed " << processed << " frames in " << seconds << " s: "
+              << processed / seconds << " fps (source " << fps << " fps)" << std::endl;
+
+    return failed ? kExitOutput : kExitOk;
+}
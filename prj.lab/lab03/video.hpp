@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+// Параметры обработки видеопотока
+struct VideoOptions {
+    std::string input;        // видеофайл, URL или номер камеры (0, 1, ...)
+    std::string output;       // видеофайл результата; пустой — только обработка
+    std::string fourcc = "mp4v";
+    double q_b = 0.1;         // нижний квантиль
+    double q_w = 0.9;         // верхний квантиль (уже 1 - q_w из командной строки)
+    double smoothing = 0.1;   // вес нового кадра в сглаженной гистограмме, 1 — без сглаживания
+    int ringSize = 4;         // кадров в обработке одновременно
+    int maxFrames = 0;        // 0 — до конца потока
+};
+
+// Автоконтрастирование видео конвейером декодирование -> анализ -> растяжение -> кодирование,
+// каждая стадия в своём потоке. Кадры живут в кольце заранее выделенных буферов, между
+// стадиями передаются только номера ячеек кольца. Границы берутся из гистограммы,
+// экспоненциально сглаженной по кадрам, поэтому яркость не мерцает от кадра к кадру.
+// По окончании печатает число кадров в секунду. Возвращает код завершения процесса (ExitCode)
+int runVideo(const VideoOptions& options);
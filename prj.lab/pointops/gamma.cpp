@@ -0,0 +1,118 @@
+#include "pointops.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace {
+
+// Таблиц для разных gamma одновременно нужно немного; при переполнении кэш очищается
+const size_t kMaxCachedTables = 64;
+
+// Таблица 1 x 65536 CV_16U, общая для всех вызовов с тем же gamma
+cv::Mat gammaTable16(double gamma) {
+    static std::mutex mutex;
+    static std::map<double, cv::Mat> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(gamma);
+    if (it != cache.end()) return it->second;
+
+    if (cache.size() >= kMaxCachedTables) cache.clear();
+    cv::Mat table(1, 65536, CV_16UC1);
+    ushort* values = table.ptr<ushort>();
+    for (int v = 0; v < 65536; ++v) {
+        values[v] = cv::saturate_cast<ushort>(std::pow(v / 65535.0, gamma) * 65535.0);
+    }
+    cache[gamma] = table;
+    return table;
+}
+
+inline float bitsToFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint32_t floatToBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// log2(x) для x > 0: показатель из битов, log2(1 + m) для мантиссы m в [0, 1) —
+// полином 7-й степени по узлам Чебышёва, погрешность 4e-7
+inline float fastLog2(float x) {
+    uint32_t bits = floatToBits(x);
+    float exponent = static_cast<float>(static_cast<int>(bits >> 23) - 127);
+    float m = bitsToFloat((bits & 0x007FFFFFu) | 0x3F800000u) - 1.0f;
+    float p = 1.444035250e-02f;
+    p = p * m - 7.565137469e-02f;
+    p = p * m + 1.887527377e-01f;
+    p = p * m - 3.219602855e-01f;
+    p = p * m + 4.720869162e-01f;
+    p = p * m - 7.203160644e-01f;
+    p = p * m + 1.442647549e+00f;
+    p = p * m + 3.685614098e-07f;
+    return exponent + p;
+}
+
+// 2^y для y в [-126, 127] (вне диапазона — насыщение): целая часть — в показатель,
+// 2^f для f в [0, 1) — полином 5-й степени, относительная погрешность 1e-7
+inline float fastExp2(float y) {
+    y = std::min(std::max(y, -126.0f), 127.0f);
+    int whole = static_cast<int>(y);          // отбрасывание дробной части, для y <= 0 — вверх
+    whole -= static_cast<float>(whole) > y;   // floor без вызова функции
+    float f = y - static_cast<float>(whole);
+    float p = 1.893754058e-03f;
+    p = p * f + 8.949590423e-03f;
+    p = p * f + 5.586033708e-02f;
+    p = p * f + 2.401418182e-01f;
+    p = p * f + 6.931544897e-01f;
+    p = p * f + 9.999998984e-01f;
+    uint32_t scale = static_cast<uint32_t>(whole + 127) << 23;
+    return p * bitsToFloat(scale);
+}
+
+// Строка без ветвлений: min/max и выбор по сравнению векторизуются, если сравнения float
+// не считаются ловушками (файл собирается с -fno-trapping-math)
+void gammaRow32f(const float* in, float* out, int n, float gamma) {
+    for (int i = 0; i < n; ++i) {
+        float v = std::min(std::max(in[i], 1e-30f), 1.0f);
+        float r = fastExp2(gamma * fastLog2(v));
+        out[i] = in[i] > 0.0f ? r : 0.0f;
+    }
+}
+
+}
+
+void applyGamma(const cv::Mat& src, double gamma, cv::Mat& dst) {
+    CV_Assert(gamma > 0);
+    switch (src.depth()) {
+    case CV_8U:
+        PointPipeline().gamma(gamma).apply(src, dst);
+        break;
+    case CV_16U:
+        applyPointLut(src, gammaTable16(gamma), dst);
+        break;
+    case CV_32F: {
+        // Заголовок источника сохраняется до create, чтобы dst мог совпадать с src
+        cv::Mat input = src;
+        dst.create(input.size(), input.type());
+        cv::Mat output = dst;
+        int n = input.cols * input.channels();
+        float g = static_cast<float>(gamma);
+        cv::parallel_for_(cv::Range(0, input.rows), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                gammaRow32f(input.ptr<float>(i), output.ptr<float>(i), n, g);
+            }
+        });
+        break;
+    }
+    default:
+        CV_Error(cv::Error::StsUnsupportedFormat, "Gamma correction supports CV_8U, CV_16U and CV_32F");
+    }
+}
@@ -0,0 +1,177 @@
+#include "pointops.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+namespace {
+
+enum PointOpKind { OP_GAMMA, OP_INVERT, OP_STRETCH, OP_CLAMP };
+
+// Больше разных цепочек одновременно не нужно; при переполнении кэш очищается
+const size_t kMaxCachedTables = 1024;
+
+// Границы растяжения меняются от кадра к кадру, и такие таблицы почти не повторяются:
+// в кэше они только вытесняли бы таблицы гаммы и инверсии. Таблица на 256 значений строится быстро
+bool isCacheable(const std::vector<double>& ops) {
+    for (size_t i = 0; i < ops.size(); i += 3) {
+        if (static_cast<int>(ops[i]) == OP_STRETCH) return false;
+    }
+    return true;
+}
+
+// Таблица одной операции
+void opTable(int kind, double a, double b, uchar* table) {
+    for (int v = 0; v < 256; ++v) {
+        switch (kind) {
+        case OP_GAMMA:
+            table[v] = cv::saturate_cast<uchar>(pow(v / 255.0, a) * 255.0);
+            break;
+        case OP_INVERT:
+            table[v] = static_cast<uchar>(255 - v);
+            break;
+        case OP_STRETCH:
+            table[v] = stretchValue(static_cast<float>(v), static_cast<float>(a), static_cast<float>(b));
+            break;
+        default:
+            table[v] = cv::saturate_cast<uchar>(std::min(std::max(static_cast<double>(v), a), b));
+            break;
+        }
+    }
+}
+
+cv::Mat buildTable(const std::vector<double>& ops) {
+    cv::Mat lut(1, 256, CV_8UC1);
+    uchar* table = lut.ptr<uchar>();
+    for (int v = 0; v < 256; ++v) table[v] = static_cast<uchar>(v);
+
+    uchar step[256];
+    for (size_t i = 0; i + 2 < ops.size(); i += 3) {
+        opTable(static_cast<int>(ops[i]), ops[i + 1], ops[i + 2], step);
+        for (int v = 0; v < 256; ++v) table[v] = step[table[v]];
+    }
+    return lut;
+}
+
+// Ядро поиска по таблицам: T — тип отсчёта источника, D — тип значения таблицы
+// (он же тип результата), CN — число каналов
+template <typename T, typename D, int CN>
+void lutKernel(const cv::Mat& src, cv::Mat& dst, const D* const* tables) {
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const T* in = src.ptr<T>(i);
+            D* out = dst.ptr<D>(i);
+            for (int j = 0; j < src.cols; ++j, in += CN, out += CN) {
+                for (int c = 0; c < CN; ++c) {
+                    out[c] = tables[c][in[c]];
+                }
+            }
+        }
+    });
+}
+
+template <typename T, typename D>
+void dispatchChannels(const cv::Mat& src, cv::Mat& dst, const D* const* tables) {
+    switch (src.channels()) {
+    case 1: lutKernel<T, D, 1>(src, dst, tables); break;
+    case 3: lutKernel<T, D, 3>(src, dst, tables); break;
+    case 4: lutKernel<T, D, 4>(src, dst, tables); break;
+    default: CV_Error(cv::Error::StsBadArg, "Only 1, 3 and 4 channel images are supported");
+    }
+}
+
+// Разнесение таблиц по каналам и запуск ядра для типа значений таблицы D
+template <typename D>
+void applyTables(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst, int bins) {
+    // Таблицы каналов раздельно; общая таблица используется всеми каналами без копирования.
+    // Раздельные таблицы — cv::Mat, чтобы буфер брался из распределителя cv::Mat (и пула)
+    int cn = src.channels();
+    cv::Mat planar;
+    const D* tables[4];
+    if (lut.channels() == 1) {
+        for (int c = 0; c < cn; ++c) tables[c] = lut.ptr<D>();
+    } else {
+        planar.create(cn, bins, lut.depth());
+        const D* interleaved = lut.ptr<D>();
+        for (int c = 0; c < cn; ++c) {
+            D* table = planar.ptr<D>(c);
+            for (int v = 0; v < bins; ++v) table[v] = interleaved[v * cn + c];
+            tables[c] = table;
+        }
+    }
+
+    // Заголовок источника сохраняется до create, чтобы dst мог совпадать с src
+    cv::Mat input = src;
+    dst.create(input.size(), CV_MAKETYPE(lut.depth(), cn));
+
+    if (input.depth() == CV_8U) {
+        dispatchChannels<uchar, D>(input, dst, tables);
+    } else {
+        dispatchChannels<ushort, D>(input, dst, tables);
+    }
+}
+
+}
+
+PointPipeline& PointPipeline::push(int kind, double a, double b) {
+    ops_.push_back(kind);
+    ops_.push_back(a);
+    ops_.push_back(b);
+    return *this;
+}
+
+PointPipeline& PointPipeline::gamma(double gamma) {
+    return push(OP_GAMMA, gamma, 0);
+}
+
+PointPipeline& PointPipeline::invert() {
+    return push(OP_INVERT, 0, 0);
+}
+
+PointPipeline& PointPipeline::stretch(float lower, float upper) {
+    return push(OP_STRETCH, lower, upper);
+}
+
+PointPipeline& PointPipeline::clamp(int lower, int upper) {
+    return push(OP_CLAMP, lower, upper);
+}
+
+cv::Mat PointPipeline::lut() const {
+    if (!isCacheable(ops_)) {
+        return buildTable(ops_);
+    }
+
+    static std::mutex mutex;
+    static std::map<std::vector<double>, cv::Mat> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(ops_);
+    if (it != cache.end()) return it->second;
+
+    if (cache.size() >= kMaxCachedTables) cache.clear();
+    cv::Mat table = buildTable(ops_);
+    cache[ops_] = table;
+    return table;
+}
+
+void PointPipeline::apply(const cv::Mat& src, cv::Mat& dst) const {
+    CV_Assert(src.depth() == CV_8U);
+    applyPointLut(src, lut(), dst);
+}
+
+void applyPointLut(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst) {
+    CV_Assert(src.depth() == CV_8U || src.depth() == CV_16U);
+    CV_Assert(src.channels() == 1 || src.channels() == 3 || src.channels() == 4);
+    CV_Assert((lut.depth() == CV_8U || lut.depth() == CV_16U) && lut.isContinuous());
+    CV_Assert(lut.channels() == 1 || lut.channels() == src.channels());
+
+    int bins = src.depth() == CV_8U ? 256 : 65536;
+    CV_Assert(static_cast<int>(lut.total()) == bins);
+
+    if (lut.depth() == CV_8U) {
+        applyTables<uchar>(src, lut, dst, bins);
+    } else {
+        applyTables<ushort>(src, lut, dst, bins);
+    }
+}
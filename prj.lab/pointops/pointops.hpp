@@ -0,0 +1,55 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Растяжение контраста одного значения: [lower, upper] -> [0, 255] с округлением как у convertTo
+inline uchar stretchValue(float pixel, float lower, float upper) {
+    if (pixel < lower) pixel = 0;
+    else if (pixel > upper) pixel = 255;
+    else pixel = (pixel - lower) / (upper - lower) * 255;
+    return cv::saturate_cast<uchar>(pixel);
+}
+
+// Цепочка точечных операций над 8-битными значениями, сводимая к одной таблице.
+// Таблицы операций композируются, поэтому результат совпадает с последовательным
+// применением операций, а цепочка из N операций стоит одного прохода по изображению
+class PointPipeline {
+public:
+    PointPipeline& gamma(double gamma);               // 255 * (v / 255)^gamma
+    PointPipeline& invert();                          // 255 - v
+    PointPipeline& stretch(float lower, float upper); // [lower, upper] -> [0, 255]
+    PointPipeline& clamp(int lower, int upper);       // ограничение диапазона
+
+    // Таблица 1 x 256 CV_8U. Таблицы одинаковых цепочек без stretch берутся из общего кэша
+    // и не должны изменяться вызывающим кодом; цепочки со stretch строятся при каждом вызове
+    cv::Mat lut() const;
+
+    // Применение цепочки за один проход; dst может совпадать с src
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+
+private:
+    PointPipeline& push(int kind, double a, double b);
+
+    std::vector<double> ops_; // тройки (вид операции, параметр, параметр) — они же ключ кэша
+};
+
+// Применение таблицы к изображению CV_8U / CV_16U с 1, 3 или 4 каналами.
+// lut — 1 x bins (256 или 65536) CV_8U или CV_16U: одноканальная таблица для всех каналов
+// или по таблице на канал, как у cv::LUT; глубина результата равна глубине таблицы.
+// Ядро специализировано по глубине входа, таблицы и числу каналов при компиляции
+void applyPointLut(const cv::Mat& src, const cv::Mat& lut, cv::Mat& dst);
+
+// Гамма-коррекция с сохранением глубины: v -> max * (v / max)^gamma, gamma > 0.
+// CV_8U — таблица PointPipeline, CV_16U — таблица на 65536 значений из кэша,
+// CV_32F (значения в [0, 1], вне диапазона ограничиваются им) — pow через полиномы log2
+// и exp2, которые компилятор векторизует; относительная погрешность меньше 1e-5.
+// CV_8U / CV_16U с 1, 3 или 4 каналами, CV_32F с любым числом каналов; dst может совпадать с src
+void applyGamma(const cv::Mat& src, double gamma, cv::Mat& dst);
+
+// Растяжение [lower, upper] -> [0, 255] без таблицы и без перевода в float: масштаб
+// с фиксированной точкой и насыщающая целочисленная арифметика, AVX2 или SSE2 по
+// возможностям процессора, иначе скалярный код. Вход CV_8U / CV_16U с любым числом
+// каналов, выход CV_8U, dst может совпадать с src. Границы округляются до целых;
+// результат отличается от stretchValue не более чем на 1 из-за округления половин
+void applyLinearStretch(const cv::Mat& src, float lower, float upper, cv::Mat& dst);
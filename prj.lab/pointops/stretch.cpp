@@ -0,0 +1,186 @@
+#include "pointops.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#define POINTOPS_HAVE_AVX2 1
+#endif
+#endif
+
+namespace {
+
+// out = min(255, (min(max(v - lower, 0), range) * scale + round) >> shift).
+// Масштаб 255 / range хранится с фиксированной точкой: shift выбран так, что scale
+// занимает все 16 бит, поэтому погрешность масштаба меньше 1/128 уровня на всём диапазоне,
+// а произведение не превышает 2^31
+struct StretchParams {
+    int lower;
+    int range;
+    uint32_t scale;
+    uint32_t round;
+    int shift;
+};
+
+StretchParams stretchParams(float lower, float upper, int maxValue) {
+    StretchParams p;
+    int lo = std::min(std::max(cvRound(lower), 0), maxValue);
+    int hi = std::min(std::max(cvRound(upper), 0), maxValue);
+    // Вырожденные границы дают порог, как у stretchValue:
+    // при upper == lower v <= lower -> 0, при upper < lower v < lower -> 0, остальное -> 255
+    if (hi < lo) {
+        p.lower = lo - 1;
+        p.range = 1;
+    } else {
+        p.lower = lo;
+        p.range = std::max(1, hi - lo);
+    }
+
+    double s = 255.0 / p.range;
+    p.shift = std::min(23, static_cast<int>(std::floor(std::log2(65535.0 / s))));
+    p.scale = static_cast<uint32_t>(std::min(65535.0, std::floor(s * (1 << p.shift) + 0.5)));
+    p.round = 1u << (p.shift - 1);
+    return p;
+}
+
+template <typename T>
+void stretchRowScalar(const T* in, uchar* out, int n, const StretchParams& p) {
+    for (int i = 0; i < n; ++i) {
+        int d = std::min(std::max(static_cast<int>(in[i]) - p.lower, 0), p.range);
+        uint32_t v = (static_cast<uint32_t>(d) * p.scale + p.round) >> p.shift;
+        out[i] = static_cast<uchar>(std::min<uint32_t>(v, 255));
+    }
+}
+
+#if defined(__SSE2__)
+
+// Восемь 16-битных отсчётов -> восемь результатов в 16-битных словах
+inline __m128i stretch8(__m128i v, __m128i lower, __m128i range, __m128i scale, __m128i round, __m128i shift) {
+    __m128i d = _mm_subs_epu16(v, lower);
+    d = _mm_sub_epi16(d, _mm_subs_epu16(d, range)); // min(d, range) без SSE4.1
+    __m128i lo = _mm_mullo_epi16(d, scale);
+    __m128i hi = _mm_mulhi_epu16(d, scale);
+    __m128i p0 = _mm_srl_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), shift);
+    __m128i p1 = _mm_srl_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), shift);
+    return _mm_packs_epi32(p0, p1);
+}
+
+template <typename T>
+void stretchRowSse2(const T* in, uchar* out, int n, const StretchParams& p) {
+    const __m128i lower = _mm_set1_epi16(static_cast<short>(p.lower));
+    const __m128i range = _mm_set1_epi16(static_cast<short>(p.range));
+    const __m128i scale = _mm_set1_epi16(static_cast<short>(p.scale));
+    const __m128i round = _mm_set1_epi32(static_cast<int>(p.round));
+    const __m128i shift = _mm_cvtsi32_si128(p.shift);
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a, b;
+        if (sizeof(T) == 1) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            a = _mm_unpacklo_epi8(v, zero);
+            b = _mm_unpackhi_epi8(v, zero);
+        } else {
+            a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+        }
+        __m128i r = _mm_packus_epi16(stretch8(a, lower, range, scale, round, shift),
+                                     stretch8(b, lower, range, scale, round, shift));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), r);
+    }
+    stretchRowScalar(in + i, out + i, n - i, p);
+}
+
+#endif
+
+#if defined(POINTOPS_HAVE_AVX2)
+
+// Те же вычисления для шестнадцати отсчётов; распаковка и упаковка внутри 128-битных
+// половин взаимно обратны, поэтому порядок отсчётов сохраняется
+__attribute__((target("avx2")))
+inline __m256i stretch16(__m256i v, __m256i lower, __m256i range, __m256i scale, __m256i round, __m128i shift) {
+    __m256i d = _mm256_subs_epu16(v, lower);
+    d = _mm256_min_epu16(d, range);
+    __m256i lo = _mm256_mullo_epi16(d, scale);
+    __m256i hi = _mm256_mulhi_epu16(d, scale);
+    __m256i p0 = _mm256_srl_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(lo, hi), round), shift);
+    __m256i p1 = _mm256_srl_epi32(_mm256_add_epi32(_mm256_unpackhi_epi16(lo, hi), round), shift);
+    return _mm256_packs_epi32(p0, p1);
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+void stretchRowAvx2(const T* in, uchar* out, int n, const StretchParams& p) {
+    const __m256i lower = _mm256_set1_epi16(static_cast<short>(p.lower));
+    const __m256i range = _mm256_set1_epi16(static_cast<short>(p.range));
+    const __m256i scale = _mm256_set1_epi16(static_cast<short>(p.scale));
+    const __m256i round = _mm256_set1_epi32(static_cast<int>(p.round));
+    const __m128i shift = _mm_cvtsi32_si128(p.shift);
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a, b;
+        if (sizeof(T) == 1) {
+            a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+            b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16)));
+        } else {
+            a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+        }
+        // packus чередует 128-битные половины a и b; перестановка возвращает порядок 0..31
+        __m256i r = _mm256_packus_epi16(stretch16(a, lower, range, scale, round, shift),
+                                        stretch16(b, lower, range, scale, round, shift));
+        r = _mm256_permute4x64_epi64(r, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+    }
+    stretchRowSse2(in + i, out + i, n - i, p);
+}
+
+#endif
+
+template <typename T>
+void stretchImage(const cv::Mat& src, cv::Mat& dst, const StretchParams& p) {
+    typedef void (*RowFn)(const T*, uchar*, int, const StretchParams&);
+
+    // Набор инструкций выбирается один раз по возможностям процессора
+    static const RowFn row =
+#if defined(POINTOPS_HAVE_AVX2)
+        cv::checkHardwareSupport(CV_CPU_AVX2) ? stretchRowAvx2<T> :
+#endif
+#if defined(__SSE2__)
+        stretchRowSse2<T>;
+#else
+        stretchRowScalar<T>;
+#endif
+
+    int n = src.cols * src.channels();
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            row(src.ptr<T>(i), dst.ptr<uchar>(i), n, p);
+        }
+    });
+}
+
+}
+
+void applyLinearStretch(const cv::Mat& src, float lower, float upper, cv::Mat& dst) {
+    CV_Assert(src.depth() == CV_8U || src.depth() == CV_16U);
+
+    int maxValue = src.depth() == CV_8U ? 255 : 65535;
+    StretchParams p = stretchParams(lower, upper, maxValue);
+
+    // Заголовок источника сохраняется до create, чтобы dst мог совпадать с src
+    cv::Mat input = src;
+    dst.create(input.size(), CV_MAKETYPE(CV_8U, input.channels()));
+
+    if (input.depth() == CV_8U) {
+        stretchImage<uchar>(input, dst, p);
+    } else {
+        stretchImage<ushort>(input, dst, p);
+    }
+}
@@ -0,0 +1,252 @@
+#include "mapped_image.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "pnm.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+enum ImageFormat { FORMAT_NONE, FORMAT_PNM, FORMAT_RAW };
+
+ImageFormat formatOf(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return FORMAT_NONE;
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext == ".pgm" || ext == ".ppm" || ext == ".pnm") return FORMAT_PNM;
+    if (ext == ".raw") return FORMAT_RAW;
+    return FORMAT_NONE;
+}
+
+// Названия глубин в описании сырого файла; индекс совпадает с кодом глубины OpenCV
+const char* kDepthNames[] = {"8U", "8S", "16U", "16S", "32S", "32F", "64F"};
+
+int depthFromName(const std::string& name) {
+    for (int depth = 0; depth < 7; ++depth) {
+        if (name == kDepthNames[depth]) return depth;
+    }
+    return -1;
+}
+
+// Описание сырого файла из <путь>.yml
+struct RawDescriptor {
+    int width = 0;
+    int height = 0;
+    int channels = 1;
+    int depth = CV_8U;
+    size_t offset = 0;
+};
+
+bool readRawDescriptor(const std::string& path, RawDescriptor& d) {
+    cv::FileStorage fs(path + ".yml", cv::FileStorage::READ);
+    if (!fs.isOpened()) return false;
+    fs["width"] >> d.width;
+    fs["height"] >> d.height;
+    if (!fs["channels"].empty()) fs["channels"] >> d.channels;
+    if (!fs["depth"].empty()) d.depth = depthFromName(static_cast<std::string>(fs["depth"]));
+    if (!fs["offset"].empty()) d.offset = static_cast<size_t>(static_cast<int>(fs["offset"]));
+    return d.width > 0 && d.height > 0 && d.channels > 0 && d.channels <= CV_CN_MAX && d.depth >= 0;
+}
+
+bool writeRawDescriptor(const std::string& path, const RawDescriptor& d) {
+    cv::FileStorage fs(path + ".yml", cv::FileStorage::WRITE);
+    if (!fs.isOpened()) return false;
+    fs << "width" << d.width << "height" << d.height << "channels" << d.channels
+       << "depth" << kDepthNames[d.depth] << "offset" << static_cast<int>(d.offset);
+    return true;
+}
+
+size_t fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? static_cast<size_t>(file.tellg()) : 0;
+}
+
+}
+
+bool isMappableImage(const std::string& path) {
+    return formatOf(path) != FORMAT_NONE;
+}
+
+MappedImage::~MappedImage() {
+    close();
+}
+
+bool MappedImage::open(const std::string& path, bool writable) {
+    close();
+
+    int rows = 0, cols = 0, type = 0;
+    size_t offset = 0;
+    bool swap = false;
+    switch (formatOf(path)) {
+    case FORMAT_PNM: {
+        std::ifstream in(path, std::ios::binary);
+        PnmHeader header;
+        if (!in || !readPnmHeader(in, header)) return false;
+        rows = header.height;
+        cols = header.width;
+        type = header.type();
+        offset = static_cast<size_t>(header.dataOffset);
+        swap = header.depth() == CV_16U && isLittleEndian();
+        if (swap && writable) return false;
+        break;
+    }
+    case FORMAT_RAW: {
+        RawDescriptor d;
+        if (!readRawDescriptor(path, d)) return false;
+        rows = d.height;
+        cols = d.width;
+        type = CV_MAKETYPE(d.depth, d.channels);
+        offset = d.offset;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    size_t rowBytes = static_cast<size_t>(cols) * CV_ELEM_SIZE(type);
+    size_t length = offset + rowBytes * rows;
+    if (fileSize(path) < length || !map(path, length, writable, false)) return false;
+
+    mat_ = cv::Mat(rows, cols, type, data_ + offset, rowBytes);
+    if (swap) {
+        swapBytes(mat_);
+    }
+    return true;
+}
+
+bool MappedImage::create(const std::string& path, int rows, int cols, int type) {
+    close();
+    CV_Assert(rows > 0 && cols > 0);
+
+    std::string header;
+    switch (formatOf(path)) {
+    case FORMAT_PNM: {
+        // 16-битный PNM хранится в big-endian и без перестановки байтов не отображается
+        int cn = CV_MAT_CN(type);
+        if (CV_MAT_DEPTH(type) != CV_8U || (cn != 1 && cn != 3)) return false;
+        std::ostringstream out;
+        writePnmHeader(out, cols, rows, cn, 255);
+        header = out.str();
+        break;
+    }
+    case FORMAT_RAW: {
+        RawDescriptor d;
+        d.width = cols;
+        d.height = rows;
+        d.channels = CV_MAT_CN(type);
+        d.depth = CV_MAT_DEPTH(type);
+        if (!writeRawDescriptor(path, d)) return false;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    size_t rowBytes = static_cast<size_t>(cols) * CV_ELEM_SIZE(type);
+    size_t length = header.size() + rowBytes * rows;
+    if (!map(path, length, true, true)) return false;
+
+    std::memcpy(data_, header.data(), header.size());
+    mat_ = cv::Mat(rows, cols, type, data_ + header.size(), rowBytes);
+    return true;
+}
+
+// Без writable отображение закрытое: запись в mat() копирует страницу и в файл не попадает
+bool MappedImage::map(const std::string& path, size_t length, bool writable, bool create) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              FILE_SHARE_READ, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    file_ = file;
+
+    ULARGE_INTEGER size;
+    size.QuadPart = length;
+    // Отображение с размером больше файла при PAGE_READWRITE увеличивает файл
+    HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_WRITECOPY,
+                                        size.HighPart, size.LowPart, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    mapping_ = mapping;
+
+    void* view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, length);
+    if (!view) {
+        close();
+        return false;
+    }
+    data_ = static_cast<uchar*>(view);
+#else
+    int flags = writable ? O_RDWR : O_RDONLY;
+    if (create) flags |= O_CREAT | O_TRUNC;
+    fd_ = ::open(path.c_str(), flags, 0644);
+    if (fd_ < 0) return false;
+    if (create && ftruncate(fd_, static_cast<off_t>(length)) != 0) {
+        close();
+        return false;
+    }
+
+    void* view = mmap(nullptr, length, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE, fd_, 0);
+    if (view == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<uchar*>(view);
+#endif
+    length_ = length;
+    return true;
+}
+
+void MappedImage::close() {
+    mat_.release();
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = nullptr;
+#else
+    if (data_) munmap(data_, length_);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+#endif
+    data_ = nullptr;
+    length_ = 0;
+}
+
+cv::Mat readImage(const std::string& path, MappedImage& mapping, int flags) {
+    if (isMappableImage(path) && mapping.open(path)) {
+        return mapping.mat();
+    }
+    return cv::imread(path, flags);
+}
+
+bool writeImage(const std::string& path, const cv::Mat& image) {
+    MappedImage output;
+    if (isMappableImage(path) && output.create(path, image.rows, image.cols, image.type())) {
+        image.copyTo(output.mat());
+        return true;
+    }
+    return cv::imwrite(path, image);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <cstddef>
+#include <string>
+
+// Изображения без кодирования, отображаемые в память: бинарные PGM/PPM (.pgm, .ppm, .pnm)
+// и сырые отсчёты (.raw) с описанием в соседнем файле <путь>.yml (cv::FileStorage):
+//   width, height, channels, depth ("8U", "16U", "32F", ...), offset (байт до данных, по умолчанию 0).
+// Сырые отсчёты хранятся в порядке байтов машины, строки идут без выравнивания
+bool isMappableImage(const std::string& path);
+
+// Файл изображения, отображённый в память. mat() — заголовок cv::Mat прямо над
+// данными файла: чтение не копирует пиксели, а запись в mat() попадает в файл,
+// если он создан через create или открыт с writable.
+// 16-битные PGM/PPM хранятся в big-endian, поэтому на little-endian машине они
+// отображаются только без writable, с перестановкой байтов в закрытой копии страниц
+class MappedImage {
+public:
+    MappedImage() = default;
+    ~MappedImage();
+
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+
+    // Отображение существующего файла. При writable изменения mat() пишутся в файл,
+    // иначе остаются в памяти процесса (страница копируется при первой записи)
+    bool open(const std::string& path, bool writable = false);
+
+    // Создание файла нужного размера (для .raw — вместе с описанием) и отображение для записи
+    bool create(const std::string& path, int rows, int cols, int type);
+
+    // Снятие отображения; изменения остаются в файле
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+
+    // Действителен до close() или разрушения объекта
+    cv::Mat& mat() { return mat_; }
+    const cv::Mat& mat() const { return mat_; }
+
+private:
+    bool map(const std::string& path, size_t length, bool writable, bool create);
+
+    uchar* data_ = nullptr;
+    size_t length_ = 0;
+    cv::Mat mat_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// Чтение изображения: PGM/PPM/raw отображаются в mapping без копирования и сохраняют своё
+// число каналов и глубину; остальные форматы читаются через cv::imread(path, flags)
+cv::Mat readImage(const std::string& path, MappedImage& mapping, int flags = cv::IMREAD_COLOR);
+
+// Запись изображения: PGM/PPM/raw — копированием строк в отображённый файл, без кодирования;
+// остальные форматы — через cv::imwrite
+bool writeImage(const std::string& path, const cv::Mat& image);
@@ -0,0 +1,114 @@
+#include "pnm.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+namespace {
+
+// Следующее целое число заголовка с пропуском пробелов и комментариев '#'
+bool readHeaderInt(std::istream& in, int& value) {
+    int c = in.peek();
+    while (c != EOF && (std::isspace(c) || c == '#')) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') c = in.get();
+        } else {
+            in.get();
+        }
+        c = in.peek();
+    }
+    return static_cast<bool>(in >> value);
+}
+
+}
+
+bool isLittleEndian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+void swapBytes(cv::Mat& image) {
+    for (int i = 0; i < image.rows; ++i) {
+        ushort* row = image.ptr<ushort>(i);
+        size_t count = static_cast<size_t>(image.cols) * image.channels();
+        for (size_t j = 0; j < count; ++j) {
+            row[j] = static_cast<ushort>((row[j] >> 8) | (row[j] << 8));
+        }
+    }
+}
+
+bool readPnmHeader(std::istream& in, PnmHeader& header) {
+    char magic[2] = {0, 0};
+    if (!in.read(magic, 2) || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) {
+        return false;
+    }
+    header.channels = magic[1] == '5' ? 1 : 3;
+
+    if (!readHeaderInt(in, header.width) || !readHeaderInt(in, header.height) ||
+        !readHeaderInt(in, header.maxval)) {
+        return false;
+    }
+    if (header.width <= 0 || header.height <= 0 || header.maxval <= 0 || header.maxval > 65535) {
+        return false;
+    }
+
+    in.get(); // ровно один пробельный символ перед данными
+    header.dataOffset = in.tellg();
+    return static_cast<bool>(in);
+}
+
+void writePnmHeader(std::ostream& out, int width, int height, int channels, int maxval) {
+    CV_Assert(channels == 1 || channels == 3);
+    out << (channels == 1 ? "P5" : "P6") << "\n" << width << " " << height << "\n" << maxval << "\n";
+}
+
+bool PnmStripReader::open(const std::string& path) {
+    file_.open(path, std::ios::binary);
+    nextRow_ = 0;
+    return file_.is_open() && readPnmHeader(file_, header_);
+}
+
+int PnmStripReader::read(cv::Mat& strip, int maxRows) {
+    int rows = std::min(maxRows, header_.height - nextRow_);
+    if (rows <= 0) return 0;
+
+    strip.create(rows, header_.width, header_.type());
+    size_t rowBytes = header_.rowBytes();
+    for (int i = 0; i < rows; ++i) {
+        if (!file_.read(reinterpret_cast<char*>(strip.ptr(i)), rowBytes)) return 0;
+    }
+    if (header_.depth() == CV_16U && isLittleEndian()) {
+        swapBytes(strip);
+    }
+
+    nextRow_ += rows;
+    return rows;
+}
+
+void PnmStripReader::rewind() {
+    file_.clear();
+    file_.seekg(header_.dataOffset);
+    nextRow_ = 0;
+}
+
+bool PnmStripWriter::open(const std::string& path, int width, int height, int channels, int maxval) {
+    file_.open(path, std::ios::binary);
+    maxval_ = maxval;
+    if (!file_.is_open()) return false;
+    writePnmHeader(file_, width, height, channels, maxval);
+    return static_cast<bool>(file_);
+}
+
+bool PnmStripWriter::write(const cv::Mat& strip) {
+    cv::Mat data = strip;
+    if (maxval_ >= 256 && isLittleEndian()) {
+        data = strip.clone();
+        swapBytes(data);
+    }
+
+    size_t rowBytes = static_cast<size_t>(data.cols) * data.elemSize();
+    for (int i = 0; i < data.rows; ++i) {
+        file_.write(reinterpret_cast<const char*>(data.ptr(i)), rowBytes);
+    }
+    return static_cast<bool>(file_);
+}
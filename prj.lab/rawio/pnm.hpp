@@ -0,0 +1,61 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <fstream>
+#include <string>
+
+// Заголовок бинарного PGM (P5) / PPM (P6)
+struct PnmHeader {
+    int width = 0;
+    int height = 0;
+    int channels = 0;         // 1 для P5, 3 для P6
+    int maxval = 0;           // до 255 — 8 бит на отсчёт, до 65535 — 16 бит (big-endian)
+    std::streamoff dataOffset = 0;
+
+    int depth() const { return maxval < 256 ? CV_8U : CV_16U; }
+    int type() const { return CV_MAKETYPE(depth(), channels); }
+    size_t rowBytes() const { return static_cast<size_t>(width) * channels * (maxval < 256 ? 1 : 2); }
+};
+
+// Чтение заголовка; false, если формат не P5/P6
+bool readPnmHeader(std::istream& in, PnmHeader& header);
+
+// Запись заголовка P5/P6 по числу каналов
+void writePnmHeader(std::ostream& out, int width, int height, int channels, int maxval);
+
+// Порядок байтов платформы: 16-битные отсчёты PNM хранятся в big-endian
+bool isLittleEndian();
+
+// Перестановка байтов всех 16-битных отсчётов изображения на месте
+void swapBytes(cv::Mat& image);
+
+// Построчное чтение PGM/PPM полосами по несколько строк, без загрузки всего изображения
+class PnmStripReader {
+public:
+    bool open(const std::string& path);
+    const PnmHeader& header() const { return header_; }
+
+    // Читает до maxRows строк в strip (тип header().type()); возвращает число прочитанных строк
+    int read(cv::Mat& strip, int maxRows);
+
+    // Возврат к первой строке для повторного прохода
+    void rewind();
+
+private:
+    std::ifstream file_;
+    PnmHeader header_;
+    int nextRow_ = 0;
+};
+
+// Построчная запись PGM/PPM полосами
+class PnmStripWriter {
+public:
+    bool open(const std::string& path, int width, int height, int channels, int maxval);
+
+    // Дописывает строки полосы; тип полосы должен соответствовать заголовку
+    bool write(const cv::Mat& strip);
+
+private:
+    std::ofstream file_;
+    int maxval_ = 255;
+};
@@ -0,0 +1,240 @@
+#include "trace.hpp"
+
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "json.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Обёртка над стандартным распределителем cv::Mat, считающая выделения.
+// Освобождение приходит через u->currAllocator, поэтому он подменяется на обёртку
+class CountingAllocator : public cv::MatAllocator {
+public:
+    explicit CountingAllocator(cv::MatAllocator* base) : base_(base) {}
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        cv::UMatData* u = base_->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (u) {
+            u->currAllocator = u->prevAllocator = this;
+            int64_t size = static_cast<int64_t>(u->size);
+            allocs.fetch_add(1);
+            allocBytes.fetch_add(size);
+            int64_t now = live.fetch_add(size) + size;
+            int64_t seen = peak.load();
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+            }
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+        return base_->allocate(u, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) return;
+        live.fetch_sub(static_cast<int64_t>(u->size));
+        u->currAllocator = u->prevAllocator = base_;
+        base_->deallocate(u);
+    }
+
+    mutable std::atomic<int64_t> allocs{0};
+    mutable std::atomic<int64_t> allocBytes{0};
+    mutable std::atomic<int64_t> live{0};
+    mutable std::atomic<int64_t> peak{0};
+
+private:
+    cv::MatAllocator* base_;
+};
+
+struct TraceEvent {
+    std::string name;
+    std::string detail;
+    std::thread::id thread;
+    double startUs;
+    double durationUs;
+    int64_t allocs;
+    int64_t allocBytes;
+    int64_t liveBytes;
+    int64_t peakBytes;
+    int64_t rssKb;
+    int64_t peakRssKb;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::string path;
+    Clock::time_point origin;
+    CountingAllocator* allocator = nullptr;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+};
+
+TraceState& state() {
+    static TraceState instance;
+    return instance;
+}
+
+// Пиковый RSS процесса, КБ
+int64_t peakRssKb() {
+#if defined(__linux__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<int64_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<int64_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+// Текущий RSS процесса, КБ; где /proc недоступен — пиковый
+int64_t currentRssKb() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    int64_t pages = 0, resident = 0;
+    if (statm >> pages >> resident) {
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+#endif
+    return peakRssKb();
+}
+
+}
+
+void traceStart(const std::string& path) {
+    TraceState& s = state();
+    if (s.enabled) return;
+    s.path = path;
+    s.origin = Clock::now();
+    // Распределитель живёт до конца процесса: им могут освобождаться матрицы,
+    // пережившие traceFinish
+    s.allocator = new CountingAllocator(cv::Mat::getDefaultAllocator());
+    cv::Mat::setDefaultAllocator(s.allocator);
+    s.enabled = true;
+}
+
+bool traceEnabled() {
+    return state().enabled.load(std::memory_order_relaxed);
+}
+
+bool traceFinish() {
+    TraceState& s = state();
+    if (!s.enabled) return true;
+    s.enabled = false;
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    // Потоки нумеруются по порядку первого события
+    std::map<std::thread::id, int> threads;
+    for (const auto& e : s.events) {
+        threads.insert(std::make_pair(e.thread, static_cast<int>(threads.size()) + 1));
+    }
+
+    std::ofstream json(s.path);
+    json << std::fixed << std::setprecision(3);
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < s.events.size(); ++i) {
+        const TraceEvent& e = s.events[i];
+        int tid = threads[e.thread];
+        json << "{\"name\":\"" << jsonEscape(e.name) << "\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1"
+             << ",\"tid\":" << tid << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs
+             << ",\"args\":{\"detail\":\"" << jsonEscape(e.detail) << "\""
+             << ",\"mat_allocs\":" << e.allocs << ",\"mat_alloc_bytes\":" << e.allocBytes
+             << ",\"live_mat_bytes\":" << e.liveBytes << ",\"peak_mat_bytes\":" << e.peakBytes
+             << ",\"peak_rss_kb\":" << e.peakRssKb << "}},\n";
+        json << "{\"name\":\"memory\",\"ph\":\"C\",\"pid\":1,\"ts\":" << e.startUs + e.durationUs
+             << ",\"args\":{\"live_mat_mb\":" << e.liveBytes / 1048576.0
+             << ",\"rss_mb\":" << e.rssKb / 1024.0 << "}}" << (i + 1 < s.events.size() ? "," : "") << "\n";
+    }
+    json << "]}\n";
+    bool written = static_cast<bool>(json);
+
+    // Сводка: суммарное время и выделения по этапам в порядке первого появления
+    struct StageTotal {
+        int calls = 0;
+        double us = 0;
+        int64_t allocs = 0;
+        int64_t allocBytes = 0;
+    };
+    std::vector<std::string> order;
+    std::map<std::string, StageTotal> totals;
+    for (const auto& e : s.events) {
+        if (!totals.count(e.name)) order.push_back(e.name);
+        StageTotal& t = totals[e.name];
+        ++t.calls;
+        t.us += e.durationUs;
+        t.allocs += e.allocs;
+        t.allocBytes += e.allocBytes;
+    }
+    std::cout << std::left << std::setw(20) << "Stage" << std::right << std::setw(8) << "Calls"
+              << std::setw(14) << "Total, ms" << std::setw(12) << "Mat allocs" << std::setw(14) << "Mat MB" << "\n";
+    for (const auto& name : order) {
+        const StageTotal& t = totals[name];
+        std::cout << std::left << std::setw(20) << name << std::right << std::setw(8) << t.calls
+                  << std::fixed << std::setprecision(3) << std::setw(14) << t.us / 1000.0
+                  << std::setw(12) << t.allocs << std::setw(14) << t.allocBytes / 1048576.0 << "\n";
+    }
+    std::cout << "Peak Mat memory: " << s.allocator->peak.load() / 1048576.0 << " MB, peak RSS: "
+              << peakRssKb() / 1024.0 << " MB\n";
+    if (written) {
+        std::cout << "Trace written to " << s.path << std::endl;
+    } else {
+        std::cout << "Could not write " << s.path << std::endl;
+    }
+
+    s.events.clear();
+    return written;
+}
+
+TraceScope::TraceScope(const char* name, const std::string& detail)
+    : name_(name), active_(traceEnabled()), allocs_(0), allocBytes_(0) {
+    if (!active_) return;
+    detail_ = detail;
+    const CountingAllocator* allocator = state().allocator;
+    allocs_ = allocator->allocs.load();
+    allocBytes_ = allocator->allocBytes.load();
+    start_ = Clock::now();
+}
+
+TraceScope::~TraceScope() {
+    if (!active_ || !traceEnabled()) return;
+    Clock::time_point end = Clock::now();
+    TraceState& s = state();
+    const CountingAllocator* allocator = s.allocator;
+
+    TraceEvent e;
+    e.name = name_;
+    e.detail = detail_;
+    e.thread = std::this_thread::get_id();
+    e.startUs = std::chrono::duration<double, std::micro>(start_ - s.origin).count();
+    e.durationUs = std::chrono::duration<double, std::micro>(end - start_).count();
+    e.allocs = allocator->allocs.load() - allocs_;
+    e.allocBytes = allocator->allocBytes.load() - allocBytes_;
+    e.liveBytes = allocator->live.load();
+    e.peakBytes = allocator->peak.load();
+    e.rssKb = currentRssKb();
+    e.peakRssKb = peakRssKb();
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.events.push_back(e);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Трассировка этапов обработки в формате Chrome trace JSON (chrome://tracing, Perfetto).
+// По умолчанию выключена, и TraceScope стоит одну проверку флага. После traceStart
+// каждый этап записывается с временем, потоком, числом и объёмом выделений cv::Mat
+// за время этапа (по всему процессу), текущим и пиковым объёмом живых cv::Mat и пиковым RSS.
+// Выделения считаются через обёртку над cv::Mat::getDefaultAllocator(); память
+// std::vector и самих кодеков в счётчики не попадает, но видна в RSS
+
+// Включение трассировки; файл пишется в traceFinish
+void traceStart(const std::string& path);
+
+bool traceEnabled();
+
+// Запись файла трассировки и сводки по этапам в std::cout. Без traceStart ничего не делает
+bool traceFinish();
+
+// Этап обработки от создания до разрушения объекта; detail — например, имя файла
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, const std::string& detail = std::string());
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    std::string detail_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+    int64_t allocs_;
+    int64_t allocBytes_;
+};